@@ -0,0 +1,94 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/content_chunker.hpp>
+#include <sak/content_chunk_reader.hpp>
+#include <sak/random_input_stream.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/// Measures the throughput of the content_chunker on a buffer in memory
+/// and through a content_chunk_reader for a number of average sizes.
+///
+/// Usage: content_chunker_benchmark [size in bytes]
+
+namespace
+{
+/// @return the throughput in MB/s of splitting the data
+double measure_split(const sak::content_chunker& chunker,
+                     const sak::const_storage& data, uint32_t passes)
+{
+    uint64_t chunks = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < passes; ++i)
+    {
+        chunks += chunker.split(data).size();
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+
+    std::cout << "average chunk " << data.m_size * passes / chunks
+              << " bytes, ";
+
+    return (double)data.m_size * passes / seconds / 1e6;
+}
+
+/// @return the throughput in MB/s of reading the chunks from a stream
+double measure_reader(const sak::content_chunker& chunker,
+                      sak::random_input_stream& stream, uint32_t passes)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < passes; ++i)
+    {
+        stream.seek(0);
+
+        sak::content_chunk_reader reader(stream, chunker);
+        sak::const_storage chunk;
+
+        while (reader.read(chunk))
+        { }
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+
+    return (double)stream.size() * passes / seconds / 1e6;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t size = 256 * 1024 * 1024;
+    uint32_t passes = 4;
+
+    if (argc > 1)
+        size = std::stoul(argv[1]);
+
+    sak::random_input_stream stream(size);
+    sak::const_storage data(stream.data(), size);
+
+    std::cout << "size: " << size << " bytes" << std::endl;
+
+    for (uint32_t average : {4096U, 8192U, 16384U, 65536U})
+    {
+        sak::content_chunker chunker(average / 4, average, average * 4);
+
+        std::cout << "average size " << average << ": ";
+        double split = measure_split(chunker, data, passes);
+        double reader = measure_reader(chunker, stream, passes);
+
+        std::cout << "split " << split << " MB/s, content_chunk_reader "
+                  << reader << " MB/s" << std::endl;
+    }
+
+    return 0;
+}
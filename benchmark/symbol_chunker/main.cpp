@@ -0,0 +1,137 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/symbol_chunker.hpp>
+#include <sak/file_input_stream.hpp>
+#include <sak/random_input_stream.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/// Measures the throughput of the symbol_chunker over an in-memory
+/// stream for a number of symbol sizes. If a directory is given, the
+/// data is also written to a temporary file in it and read using a file
+/// stream.
+///
+/// Usage: symbol_chunker_benchmark [size in bytes] [generation size]
+///        [directory]
+
+namespace
+{
+/// Removes a file when it goes out of scope
+struct scoped_file
+{
+    scoped_file(const std::string& name) :
+        m_name(name)
+    { }
+
+    ~scoped_file()
+    {
+        std::remove(m_name.c_str());
+    }
+
+    std::string m_name;
+};
+
+/// Reads all generations a number of times
+/// @return the throughput in MB/s
+double measure(sak::symbol_chunker& chunker, uint32_t passes)
+{
+    // Touch the data so the loop is not optimized away
+    volatile uint8_t last = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i = 0; i < passes; ++i)
+    {
+        chunker.reset();
+
+        while (!chunker.finished())
+        {
+            sak::mutable_storage symbols = chunker.next();
+            last = symbols.m_data[symbols.m_size - 1];
+        }
+    }
+
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+
+    (void)last;
+    return (double)chunker.size() * passes / seconds / 1e6;
+}
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t size = 256 * 1024 * 1024;
+    uint32_t generation_size = 64;
+    uint32_t passes = 4;
+
+    if (argc > 1)
+        size = std::stoul(argv[1]);
+
+    if (argc > 2)
+        generation_size = std::stoul(argv[2]);
+
+    auto random = std::make_shared<sak::random_input_stream>(size);
+
+    std::unique_ptr<scoped_file> temporary;
+    std::shared_ptr<sak::file_input_stream> file;
+
+    if (argc > 3)
+    {
+        temporary.reset(new scoped_file(
+            std::string(argv[3]) + "/symbol_chunker_benchmark.bin"));
+
+        std::ofstream output(temporary->m_name.c_str(),
+                             std::ios::out | std::ios::binary);
+        output.write((const char*)random->data(), size);
+        output.close();
+
+        if (!output)
+        {
+            std::cerr << "failed to write " << temporary->m_name
+                      << std::endl;
+            return 1;
+        }
+
+        file = std::make_shared<sak::file_input_stream>(temporary->m_name);
+    }
+
+    std::cout << "size: " << size << " bytes, generation size: "
+              << generation_size << std::endl;
+
+    for (uint32_t symbol_size : {64U, 1400U, 4096U, 65536U})
+    {
+        random->seek(0);
+
+        sak::symbol_chunker memory_chunker(
+            random, symbol_size, generation_size);
+
+        std::cout << "symbol size " << symbol_size
+                  << ": random_input_stream "
+                  << measure(memory_chunker, passes) << " MB/s";
+
+        if (file)
+        {
+            file->seek(0);
+
+            sak::symbol_chunker file_chunker(
+                file, symbol_size, generation_size);
+
+            std::cout << ", file_input_stream "
+                      << measure(file_chunker, passes) << " MB/s";
+        }
+
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
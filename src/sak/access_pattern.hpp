@@ -0,0 +1,26 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+namespace sak
+{
+/// Hints describing how the data of a file will be accessed, which can be
+/// passed on to the operating system by the file based input streams
+enum class access_pattern
+{
+    /// No particular access pattern
+    normal,
+
+    /// The data is read from start to end
+    sequential,
+
+    /// The data is read at random positions
+    random,
+
+    /// The data will be read soon and should be prefetched
+    willneed
+};
+}
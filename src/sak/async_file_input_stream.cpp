@@ -0,0 +1,841 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "async_file_input_stream.hpp"
+#include "async_read_backend.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define SAK_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace sak
+{
+namespace detail
+{
+/// Performs the reads with pread() on a pool of worker threads
+class thread_pool_backend : public async_read_backend
+{
+public:
+
+    /// @param threads the number of worker threads
+    thread_pool_backend(uint32_t threads) :
+        m_stop(false)
+    {
+        for (uint32_t i = 0; i < threads; ++i)
+        {
+            m_threads.emplace_back(&thread_pool_backend::work, this);
+        }
+    }
+
+    ~thread_pool_backend()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_request_ready.notify_all();
+
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    void submit(const read_request& request)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back(request);
+        }
+        m_request_ready.notify_one();
+    }
+
+    int wait(std::vector<read_completion>& completions, bool block)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if (block)
+        {
+            m_completion_ready.wait(lock, [this]()
+            {
+                return !m_completions.empty();
+            });
+        }
+
+        completions.insert(completions.end(), m_completions.begin(),
+                           m_completions.end());
+        m_completions.clear();
+        return 0;
+    }
+
+private:
+
+    void work()
+    {
+        while (true)
+        {
+            read_request request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_request_ready.wait(lock, [this]()
+                {
+                    return m_stop || !m_requests.empty();
+                });
+
+                if (m_requests.empty())
+                    return;
+
+                request = m_requests.front();
+                m_requests.pop_front();
+            }
+
+            ssize_t result;
+            do
+            {
+                result = ::pread(request.m_fd, request.m_data,
+                                 request.m_size, request.m_offset);
+            }
+            while (result < 0 && errno == EINTR);
+
+            read_completion completion;
+            completion.m_slot = request.m_slot;
+            completion.m_result = result < 0 ? -errno : (int32_t)result;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_completions.push_back(completion);
+            }
+            m_completion_ready.notify_one();
+        }
+    }
+
+private:
+
+    std::mutex m_mutex;
+    std::condition_variable m_request_ready;
+    std::condition_variable m_completion_ready;
+    std::deque<read_request> m_requests;
+    std::vector<read_completion> m_completions;
+    std::vector<std::thread> m_threads;
+    bool m_stop;
+};
+
+#if defined(SAK_HAS_IO_URING)
+/// Performs the reads using io_uring. The system calls are used
+/// directly, so liburing is not needed.
+class io_uring_backend : public async_read_backend
+{
+public:
+
+    /// Sets up an io_uring
+    /// @param entries the maximum number of reads in flight
+    /// @return the backend or nullptr if io_uring is not available
+    static std::unique_ptr<async_read_backend> create(uint32_t entries)
+    {
+        std::unique_ptr<io_uring_backend> backend(new io_uring_backend());
+
+        if (!backend->setup(entries))
+            return nullptr;
+
+        return std::unique_ptr<async_read_backend>(backend.release());
+    }
+
+    ~io_uring_backend()
+    {
+        if (m_sqes != nullptr)
+            ::munmap(m_sqes, m_sqes_size);
+        if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+            ::munmap(m_cq_ring, m_cq_ring_size);
+        if (m_sq_ring != MAP_FAILED)
+            ::munmap(m_sq_ring, m_sq_ring_size);
+        if (m_ring_fd >= 0)
+            ::close(m_ring_fd);
+    }
+
+    void submit(const read_request& request)
+    {
+        assert(request.m_slot < m_iovecs.size());
+
+        iovec& vec = m_iovecs[request.m_slot];
+        vec.iov_base = request.m_data;
+        vec.iov_len = request.m_size;
+
+        unsigned tail = *m_sq_tail;
+        unsigned index = tail & *m_sq_mask;
+
+        io_uring_sqe* sqe = &m_sqes[index];
+        std::memset(sqe, 0, sizeof(io_uring_sqe));
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = request.m_fd;
+        sqe->addr = (uint64_t)(uintptr_t)&vec;
+        sqe->len = 1;
+        sqe->off = request.m_offset;
+        sqe->user_data = request.m_slot;
+
+        m_sq_array[index] = index;
+        __atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++m_unsubmitted;
+    }
+
+    void flush()
+    {
+        while (m_unsubmitted > 0)
+        {
+            int result = enter(m_unsubmitted, 0, 0);
+
+            if (result < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                    continue;
+
+                discard_unsubmitted(-errno);
+                return;
+            }
+
+            m_unsubmitted -= (uint32_t)result;
+        }
+    }
+
+    int wait(std::vector<read_completion>& completions, bool block)
+    {
+        flush();
+
+        completions.insert(completions.end(), m_discarded.begin(),
+                           m_discarded.end());
+        block = block && m_discarded.empty();
+        m_discarded.clear();
+
+        unsigned head = *m_cq_head;
+
+        if (block && head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE))
+        {
+            while (enter(0, 1, IORING_ENTER_GETEVENTS) < 0)
+            {
+                if (errno != EINTR)
+                    return -errno;
+            }
+        }
+
+        unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+
+            read_completion completion;
+            completion.m_slot = (uint32_t)cqe.user_data;
+            completion.m_result = cqe.res;
+            completions.push_back(completion);
+        }
+
+        __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+private:
+
+    io_uring_backend() :
+        m_ring_fd(-1),
+        m_sq_ring(MAP_FAILED),
+        m_cq_ring(MAP_FAILED),
+        m_sqes(nullptr),
+        m_unsubmitted(0)
+    { }
+
+    bool setup(uint32_t entries)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        m_ring_fd = (int)::syscall(__NR_io_uring_setup, entries, &params);
+
+        if (m_ring_fd < 0)
+            return false;
+
+        m_sq_ring_size =
+            params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cq_ring_size =
+            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+        if (single_mmap)
+        {
+            m_sq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+            m_cq_ring_size = m_sq_ring_size;
+        }
+
+        m_sq_ring = ::mmap(0, m_sq_ring_size, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                           IORING_OFF_SQ_RING);
+
+        if (m_sq_ring == MAP_FAILED)
+            return false;
+
+        m_cq_ring = single_mmap ? m_sq_ring :
+            ::mmap(0, m_cq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                   IORING_OFF_CQ_RING);
+
+        if (m_cq_ring == MAP_FAILED)
+            return false;
+
+        m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(0, m_sqes_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                            IORING_OFF_SQES);
+
+        if (sqes == MAP_FAILED)
+            return false;
+
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        uint8_t* sq = static_cast<uint8_t*>(m_sq_ring);
+        m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+        uint8_t* cq = static_cast<uint8_t*>(m_cq_ring);
+        m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        m_iovecs.resize(entries);
+        return true;
+    }
+
+    /// Removes the reads the kernel did not accept from the submission
+    /// queue and completes them with an error
+    /// @param error the negative errno value to complete the reads with
+    void discard_unsubmitted(int32_t error)
+    {
+        unsigned tail = *m_sq_tail;
+
+        for (unsigned i = tail - m_unsubmitted; i != tail; ++i)
+        {
+            const io_uring_sqe& sqe = m_sqes[m_sq_array[i & *m_sq_mask]];
+
+            read_completion completion;
+            completion.m_slot = (uint32_t)sqe.user_data;
+            completion.m_result = error;
+            m_discarded.push_back(completion);
+        }
+
+        __atomic_store_n(m_sq_tail, tail - m_unsubmitted, __ATOMIC_RELEASE);
+        m_unsubmitted = 0;
+    }
+
+    int enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags)
+    {
+        return (int)::syscall(__NR_io_uring_enter, m_ring_fd, to_submit,
+                              min_complete, flags, nullptr, 0);
+    }
+
+private:
+
+    int m_ring_fd;
+
+    void* m_sq_ring;
+    size_t m_sq_ring_size;
+    void* m_cq_ring;
+    size_t m_cq_ring_size;
+    io_uring_sqe* m_sqes;
+    size_t m_sqes_size;
+
+    unsigned* m_sq_tail;
+    unsigned* m_sq_mask;
+    unsigned* m_sq_array;
+    unsigned* m_cq_head;
+    unsigned* m_cq_tail;
+    unsigned* m_cq_mask;
+    io_uring_cqe* m_cqes;
+
+    /// The read vectors, one per buffer slot
+    std::vector<iovec> m_iovecs;
+
+    /// The number of queued reads not yet passed to the kernel
+    uint32_t m_unsubmitted;
+
+    /// The reads the kernel refused, reported by the next wait()
+    std::vector<read_completion> m_discarded;
+};
+#endif
+}
+
+async_file_input_stream::async_file_input_stream(
+    uint32_t queue_depth, uint32_t block_size, backend_type preferred) :
+    m_backend_type(backend_type::thread_pool),
+    m_fd(-1),
+    m_size(0),
+    m_slots(queue_depth),
+    m_next_offset(0),
+    m_submitted(0),
+    m_completed(0),
+    m_consumed(0),
+    m_consumed_offset(0),
+    m_available(0),
+    m_failed(false),
+    m_stopped_notified(false)
+{
+    assert(queue_depth > 0);
+    assert(block_size > 0);
+
+    for (auto& slot : m_slots)
+    {
+        slot.m_data.resize(block_size);
+        slot.m_offset = 0;
+        slot.m_size = 0;
+        slot.m_filled = 0;
+        slot.m_pending = false;
+    }
+
+#if defined(SAK_HAS_IO_URING)
+    if (preferred == backend_type::io_uring)
+    {
+        m_backend = detail::io_uring_backend::create(queue_depth);
+
+        if (m_backend)
+        {
+            m_backend_type = backend_type::io_uring;
+        }
+    }
+#else
+    (void) preferred;
+#endif
+
+    if (!m_backend)
+    {
+        m_backend.reset(new detail::thread_pool_backend(queue_depth));
+    }
+}
+
+async_file_input_stream::async_file_input_stream(
+    std::unique_ptr<detail::async_read_backend> backend,
+    uint32_t queue_depth, uint32_t block_size) :
+    m_backend_type(backend_type::custom),
+    m_backend(std::move(backend)),
+    m_fd(-1),
+    m_size(0),
+    m_slots(queue_depth),
+    m_next_offset(0),
+    m_submitted(0),
+    m_completed(0),
+    m_consumed(0),
+    m_consumed_offset(0),
+    m_available(0),
+    m_failed(false),
+    m_stopped_notified(false)
+{
+    assert(m_backend);
+    assert(queue_depth > 0);
+    assert(block_size > 0);
+
+    for (auto& slot : m_slots)
+    {
+        slot.m_data.resize(block_size);
+        slot.m_offset = 0;
+        slot.m_size = 0;
+        slot.m_filled = 0;
+        slot.m_pending = false;
+    }
+}
+
+async_file_input_stream::~async_file_input_stream()
+{
+    if (is_open())
+    {
+        close();
+    }
+}
+
+void async_file_input_stream::open(const std::string& filename)
+{
+    assert(!is_open());
+
+    std::error_code ec;
+    open(filename, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void async_file_input_stream::open(const std::string& filename,
+                                   std::error_code& ec)
+{
+    assert(!is_open());
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        ec = error::failed_open_file;
+        return;
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        ec = error::failed_open_file;
+        return;
+    }
+
+    // The size of the stream is limited to 32 bits
+    if ((uint64_t)status.st_size > std::numeric_limits<uint32_t>::max())
+    {
+        ::close(fd);
+        ec = error::file_too_large;
+        return;
+    }
+
+    m_fd = fd;
+    m_size = (uint32_t)status.st_size;
+    m_next_offset = 0;
+    m_submitted = 0;
+    m_completed = 0;
+    m_consumed = 0;
+    m_consumed_offset = 0;
+    m_available = 0;
+    m_failed = false;
+    m_stopped_notified = false;
+
+    submit_reads();
+}
+
+void async_file_input_stream::close()
+{
+    assert(is_open());
+
+    // The buffers must not be released while the reads are in flight
+    std::vector<detail::read_completion> completions;
+    while (in_flight() > 0)
+    {
+        completions.clear();
+
+        if (m_backend->wait(completions, true) < 0)
+        {
+            // The reads can no longer be waited for
+            for (auto& slot : m_slots)
+            {
+                slot.m_pending = false;
+            }
+            break;
+        }
+
+        for (const auto& completion : completions)
+        {
+            m_slots[completion.m_slot].m_pending = false;
+        }
+    }
+
+    ::close(m_fd);
+    m_fd = -1;
+}
+
+bool async_file_input_stream::is_open() const
+{
+    return m_fd >= 0;
+}
+
+async_file_input_stream::backend_type
+async_file_input_stream::backend() const
+{
+    return m_backend_type;
+}
+
+uint32_t async_file_input_stream::size() const
+{
+    assert(is_open());
+    return m_size;
+}
+
+uint32_t async_file_input_stream::poll()
+{
+    assert(is_open());
+    return dispatch(false);
+}
+
+void async_file_input_stream::run()
+{
+    assert(is_open());
+
+    do
+    {
+        dispatch(true);
+    }
+    while (!stopped() && in_flight() > 0);
+}
+
+void async_file_input_stream::read(uint8_t* buffer, uint32_t bytes)
+{
+    assert(is_open());
+    assert(buffer != 0);
+    assert(bytes <= m_available);
+
+    copy_available(buffer, bytes);
+    consume(bytes);
+}
+
+const_storage async_file_input_stream::peek(uint32_t max_bytes)
+{
+    assert(is_open());
+
+    uint32_t bytes = std::min(max_bytes, m_available);
+
+    if (bytes == 0)
+        return const_storage();
+
+    // Return the data directly if it is in a single buffer
+    const slot& current = m_slots[m_consumed % m_slots.size()];
+
+    if (bytes <= current.m_size - m_consumed_offset)
+    {
+        return const_storage(current.m_data.data() + m_consumed_offset,
+                             bytes);
+    }
+
+    m_peek_buffer.resize(bytes);
+    copy_available(m_peek_buffer.data(), bytes);
+    return const_storage(m_peek_buffer.data(), bytes);
+}
+
+void async_file_input_stream::consume(uint32_t bytes)
+{
+    assert(is_open());
+    assert(bytes <= m_available);
+
+    m_available -= bytes;
+
+    while (bytes > 0)
+    {
+        assert(m_consumed < m_completed);
+
+        const slot& current = m_slots[m_consumed % m_slots.size()];
+        uint32_t step = std::min(bytes, current.m_size - m_consumed_offset);
+
+        bytes -= step;
+        m_consumed_offset += step;
+
+        // Re-use the buffer once it has been consumed
+        if (m_consumed_offset == current.m_size)
+        {
+            ++m_consumed;
+            m_consumed_offset = 0;
+        }
+    }
+
+    submit_reads();
+}
+
+uint32_t async_file_input_stream::bytes_available()
+{
+    return m_available;
+}
+
+bool async_file_input_stream::stopped()
+{
+    return m_failed ||
+        (m_next_offset == m_size && m_completed == m_submitted);
+}
+
+uint32_t async_file_input_stream::dispatch(bool wait)
+{
+    uint32_t before = m_available;
+
+    if (in_flight() > 0)
+    {
+        std::vector<detail::read_completion> completions;
+        int result = m_backend->wait(completions, wait);
+
+        if (result < 0)
+        {
+            // None of the reads in flight will be reported as completed
+            for (auto& slot : m_slots)
+            {
+                slot.m_pending = false;
+            }
+
+            fail(std::system_category().message(-result));
+        }
+
+        for (const auto& completion : completions)
+        {
+            slot& current = m_slots[completion.m_slot];
+
+            // Ignore reads which have already been failed
+            if (!current.m_pending)
+                continue;
+
+            current.m_pending = false;
+
+            if (completion.m_result <= 0)
+            {
+                fail(completion.m_result == 0 ? "Unexpected end of file" :
+                     std::system_category().message(-completion.m_result));
+                continue;
+            }
+
+            current.m_filled += (uint32_t)completion.m_result;
+
+            // Continue a short read
+            if (current.m_filled < current.m_size && !m_failed)
+            {
+                submit(completion.m_slot);
+            }
+        }
+
+        // Make the buffers read in file order available
+        while (!m_failed && m_completed < m_submitted)
+        {
+            const slot& next = m_slots[m_completed % m_slots.size()];
+
+            if (next.m_pending || next.m_filled < next.m_size)
+                break;
+
+            m_available += next.m_size;
+            ++m_completed;
+        }
+
+        m_backend->flush();
+    }
+
+    uint32_t bytes = m_available - before;
+
+    if (bytes > 0 && m_ready_read_callback)
+    {
+        m_ready_read_callback();
+    }
+
+    if (stopped() && !m_stopped_notified)
+    {
+        m_stopped_notified = true;
+
+        if (m_stopped_callback)
+        {
+            m_stopped_callback();
+        }
+    }
+
+    return bytes;
+}
+
+void async_file_input_stream::submit_reads()
+{
+    uint64_t end = m_consumed + m_slots.size();
+
+    while (!m_failed && m_submitted < end && m_next_offset < m_size)
+    {
+        uint32_t index = (uint32_t)(m_submitted % m_slots.size());
+        slot& next = m_slots[index];
+
+        next.m_offset = m_next_offset;
+        next.m_size = std::min<uint32_t>(next.m_data.size(),
+                                         m_size - m_next_offset);
+        next.m_filled = 0;
+
+        submit(index);
+
+        m_next_offset += next.m_size;
+        ++m_submitted;
+    }
+
+    m_backend->flush();
+}
+
+void async_file_input_stream::submit(uint32_t index)
+{
+    slot& current = m_slots[index];
+    assert(!current.m_pending);
+    assert(current.m_filled < current.m_size);
+
+    detail::read_request request;
+    request.m_slot = index;
+    request.m_fd = m_fd;
+    request.m_data = current.m_data.data() + current.m_filled;
+    request.m_size = current.m_size - current.m_filled;
+    request.m_offset = current.m_offset + current.m_filled;
+
+    current.m_pending = true;
+    m_backend->submit(request);
+}
+
+void async_file_input_stream::copy_available(uint8_t* buffer,
+                                             uint32_t bytes) const
+{
+    assert(bytes <= m_available);
+
+    uint64_t sequence = m_consumed;
+    uint32_t offset = m_consumed_offset;
+
+    while (bytes > 0)
+    {
+        assert(sequence < m_completed);
+
+        const slot& current = m_slots[sequence % m_slots.size()];
+        uint32_t copy = std::min(bytes, current.m_size - offset);
+
+        std::copy_n(current.m_data.data() + offset, copy, buffer);
+
+        buffer += copy;
+        bytes -= copy;
+
+        ++sequence;
+        offset = 0;
+    }
+}
+
+void async_file_input_stream::fail(const std::string& message)
+{
+    if (m_failed)
+        return;
+
+    m_failed = true;
+
+    if (m_error_callback)
+    {
+        m_error_callback(message);
+    }
+}
+
+uint32_t async_file_input_stream::in_flight() const
+{
+    uint32_t count = 0;
+    for (const auto& slot : m_slots)
+    {
+        count += slot.m_pending ? 1 : 0;
+    }
+    return count;
+}
+}
+
+#endif
@@ -0,0 +1,243 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "sak::async_file_input_stream requires a POSIX platform"
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "error.hpp"
+#include "input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+// Do not expose implementation details to users of this header file
+namespace detail
+{
+class async_read_backend;
+}
+
+/// An asynchronous file input stream which keeps a number of reads in
+/// flight into a ring of buffers.
+///
+/// The stream is only available on POSIX platforms. On Linux the reads
+/// are submitted through io_uring, otherwise or if io_uring is not
+/// available, they are performed with pread() by a pool of worker
+/// threads. In both cases the callbacks are invoked from the
+/// thread calling poll() or run(). The ready read callback is invoked
+/// when new data is available in file order, the stopped callback when
+/// the whole file has been read and the error callback if a read fails.
+///
+/// As soon as a buffer has been completely consumed with read() or
+/// consume(), it is re-used for the next block of the file.
+///
+/// Example:
+///
+///     sak::async_file_input_stream stream;
+///     stream.open("data.bin");
+///     stream.on_ready_read([&]()
+///     {
+///         std::vector<uint8_t> data(stream.bytes_available());
+///         stream.read(data.data(), data.size());
+///     });
+///     stream.run();
+///
+class async_file_input_stream : public input_stream
+{
+public:
+
+    /// The mechanism used to perform the reads
+    enum class backend_type
+    {
+        /// Linux io_uring
+        io_uring,
+
+        /// pread() on worker threads
+        thread_pool,
+
+        /// A backend given to the constructor
+        custom
+    };
+
+public:
+
+    /// Constructor
+    /// @param queue_depth the number of reads to keep in flight
+    /// @param block_size the size of each read in bytes
+    /// @param preferred the preferred backend, io_uring falls back to
+    ///        the thread pool if it is not available
+    async_file_input_stream(uint32_t queue_depth = 8,
+                            uint32_t block_size = 65536,
+                            backend_type preferred = backend_type::io_uring);
+
+    /// Constructor using a custom backend, e.g. to inject failures in
+    /// tests. The backend is declared in async_read_backend.hpp.
+    /// @param backend the backend, must accept queue_depth reads in
+    ///        flight
+    /// @param queue_depth the number of reads to keep in flight
+    /// @param block_size the size of each read in bytes
+    async_file_input_stream(
+        std::unique_ptr<detail::async_read_backend> backend,
+        uint32_t queue_depth = 8, uint32_t block_size = 65536);
+
+    /// Destructor, closes the file if it is open
+    ~async_file_input_stream();
+
+    /// The stream is not copyable
+    async_file_input_stream(const async_file_input_stream&) = delete;
+
+    /// The stream is not copyable
+    async_file_input_stream& operator=(
+        const async_file_input_stream&) = delete;
+
+    /// Opens the file and starts reading it
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the file name
+    void open(const std::string& filename);
+
+    /// Opens the file and starts reading it
+    /// @param filename the file name
+    /// @param ec on error set to indicate the type of error, files of
+    ///        4 GiB or more are rejected with error::file_too_large
+    void open(const std::string& filename, std::error_code& ec);
+
+    /// Waits for the reads in flight and closes the file
+    void close();
+
+    /// @return true if a file is open
+    bool is_open() const;
+
+    /// @return the backend used for the reads
+    backend_type backend() const;
+
+    /// @return the size of the file in bytes
+    uint32_t size() const;
+
+    /// Handles the completed reads without blocking and invokes the
+    /// callbacks
+    /// @return the number of bytes which became available
+    uint32_t poll();
+
+    /// Handles completed reads and invokes the callbacks until the stream
+    /// is stopped, or until no reads are in flight because all buffers
+    /// hold data which has not been read.
+    void run();
+
+public: // From input_stream
+
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
+    void read(uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc input_stream::bytes_available()
+    uint32_t bytes_available();
+
+    /// @copydoc input_stream::stopped()
+    bool stopped();
+
+    /// @copydoc input_stream::peek()
+    const_storage peek(uint32_t max_bytes);
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes);
+
+private:
+
+    /// Handles completed reads
+    /// @param wait if true block until at least one read completes
+    /// @return the number of bytes which became available
+    uint32_t dispatch(bool wait);
+
+    /// Submits reads into all free buffers
+    void submit_reads();
+
+    /// Submits the read of the unfilled part of a buffer
+    void submit(uint32_t slot);
+
+    /// Copies available data without consuming it
+    /// @param buffer the buffer to copy to
+    /// @param bytes the number of bytes to copy
+    void copy_available(uint8_t* buffer, uint32_t bytes) const;
+
+    /// Stops the stream after an error
+    void fail(const std::string& message);
+
+    /// @return the number of reads in flight
+    uint32_t in_flight() const;
+
+private:
+
+    /// A buffer in the ring
+    struct slot
+    {
+        /// The data
+        std::vector<uint8_t> m_data;
+
+        /// The offset in the file of the data
+        uint32_t m_offset;
+
+        /// The number of bytes to read into the buffer
+        uint32_t m_size;
+
+        /// The number of bytes read into the buffer
+        uint32_t m_filled;
+
+        /// True when the buffer is being read into
+        bool m_pending;
+    };
+
+    /// The backend in use
+    backend_type m_backend_type;
+
+    /// The backend performing the reads
+    std::unique_ptr<detail::async_read_backend> m_backend;
+
+    /// The file descriptor, -1 if no file is open
+    int m_fd;
+
+    /// The size of the file in bytes
+    uint32_t m_size;
+
+    /// The ring of buffers
+    std::vector<slot> m_slots;
+
+    /// The offset in the file of the next read to submit
+    uint32_t m_next_offset;
+
+    /// Sequence number of the next buffer to submit a read into
+    uint64_t m_submitted;
+
+    /// Sequence number of the first buffer which is not completely read
+    /// from the file
+    uint64_t m_completed;
+
+    /// Sequence number of the buffer being consumed
+    uint64_t m_consumed;
+
+    /// The read position within the buffer being consumed
+    uint32_t m_consumed_offset;
+
+    /// The number of bytes available in file order
+    uint32_t m_available;
+
+    /// True if a read has failed
+    bool m_failed;
+
+    /// True when the stopped callback has been invoked
+    bool m_stopped_notified;
+
+    /// Buffer holding the data of peek() when it spans several buffers
+    std::vector<uint8_t> m_peek_buffer;
+};
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "sak::async_file_input_stream requires a POSIX platform"
+#endif
+
+#include <cstdint>
+#include <vector>
+
+namespace sak
+{
+// The mechanisms performing the reads of sak::async_file_input_stream.
+// Only needed to implement a custom backend.
+namespace detail
+{
+/// A read of a buffer slot
+struct read_request
+{
+    /// The buffer slot
+    uint32_t m_slot;
+
+    /// The file descriptor
+    int m_fd;
+
+    /// The buffer to read into
+    uint8_t* m_data;
+
+    /// The number of bytes to read
+    uint32_t m_size;
+
+    /// The offset in the file
+    uint32_t m_offset;
+};
+
+/// The result of a read
+struct read_completion
+{
+    /// The buffer slot
+    uint32_t m_slot;
+
+    /// The number of bytes read or a negative errno value
+    int32_t m_result;
+};
+
+/// Interface of the mechanisms performing the reads
+class async_read_backend
+{
+public:
+
+    virtual ~async_read_backend()
+    {}
+
+    /// Queues a read
+    virtual void submit(const read_request& request) = 0;
+
+    /// Starts the queued reads
+    virtual void flush()
+    {}
+
+    /// Collects the completed reads
+    /// @param completions the completed reads are appended here
+    /// @param block if true wait for at least one read to complete
+    /// @return zero, or a negative errno value if waiting failed, in
+    ///         which case the reads in flight are considered failed
+    virtual int wait(std::vector<read_completion>& completions,
+                     bool block) = 0;
+};
+}
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "bit_reader.hpp"
+
+namespace sak
+{
+
+bit_reader::bit_reader(const uint8_t* buffer, uint32_t size) :
+    m_buffer(buffer), m_size(size), m_position(0)
+{
+    assert(m_buffer != 0);
+    assert(m_size);
+}
+
+bit_reader::bit_reader(const const_storage& storage) :
+    m_buffer(storage.m_data), m_size(storage.m_size), m_position(0)
+{
+    assert(m_buffer != 0);
+    assert(m_size);
+}
+
+void bit_reader::skip(uint64_t bits)
+{
+    assert(bits_available() >= bits);
+    m_position += bits;
+}
+
+void bit_reader::align()
+{
+    m_position = (m_position + 7) / 8 * 8;
+    assert(m_position <= uint64_t(m_size) * 8);
+}
+
+uint64_t bit_reader::bits_read() const
+{
+    return m_position;
+}
+
+uint32_t bit_reader::size() const
+{
+    return m_size;
+}
+
+uint64_t bit_reader::load_tail(uint32_t byte) const
+{
+    assert(byte < m_size);
+
+    uint64_t word = 0;
+    for (uint32_t i = 0; byte + i < m_size; ++i)
+    {
+        word |= uint64_t(m_buffer[byte + i]) << (56 - 8 * i);
+    }
+    return word;
+}
+
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "storage.hpp"
+#include "convert_endian.hpp"
+
+namespace sak
+{
+/// The bit_reader extracts fields of 1 to 64 bits from a fixed-size
+/// buffer written by the sak::bit_writer, i.e. the fields are read most
+/// significant bit first.
+///
+/// Each field is extracted from a single 64-bit big-endian load at the
+/// byte containing the current bit position. Only fields wider than 57
+/// bits and loads near the end of the buffer take a slower path.
+class bit_reader
+{
+public:
+
+    /// Creates a bit reader on top of a buffer of the specified size
+    /// @param buffer a pointer to the buffer
+    /// @param size the size of the buffer in bytes
+    bit_reader(const uint8_t* buffer, uint32_t size);
+
+    /// Creates a bit reader on top of a const storage
+    /// @param storage the const storage
+    bit_reader(const const_storage& storage);
+
+    /// Reads a field from the stream and moves the read position
+    /// @param bits the width of the field in bits (1 to 64)
+    /// @return the value of the field
+    uint64_t read(uint32_t bits)
+    {
+        assert(bits > 0 && bits <= 64);
+
+        // Make sure there is enough data to read in the underlying buffer
+        assert(bits_available() >= bits);
+
+        // A field starting within a byte can use at most 57 bits of the
+        // loaded word, read wider fields in two parts
+        if (bits > 57)
+        {
+            uint64_t high = read(bits - 32);
+            return (high << 32) | read(32);
+        }
+
+        uint32_t byte = static_cast<uint32_t>(m_position / 8);
+        uint64_t word = (m_size - byte >= 8) ?
+            big_endian::get64(&m_buffer[byte]) : load_tail(byte);
+
+        uint64_t value = (word << (m_position % 8)) >> (64 - bits);
+        m_position += bits;
+        return value;
+    }
+
+    /// Reads a field from the stream and moves the read position
+    /// @param value reference to the value to be read
+    /// @param bits the width of the field in bits
+    template<class ValueType>
+    void read(ValueType& value, uint32_t bits)
+    {
+        assert(bits <= sizeof(ValueType) * 8);
+        value = static_cast<ValueType>(read(bits));
+    }
+
+    /// Reads a number of fields of the same width from the stream
+    /// @param values pointer to where the values are stored
+    /// @param count the number of values to read
+    /// @param bits the width of each field in bits
+    template<class ValueType>
+    void read_array(ValueType* values, uint32_t count, uint32_t bits)
+    {
+        assert(values != 0 || count == 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            read(values[i], bits);
+        }
+    }
+
+    /// Moves the read position forward
+    /// @param bits the number of bits to skip
+    void skip(uint64_t bits);
+
+    /// Moves the read position forward to the next byte boundary, this
+    /// skips the padding written by sak::bit_writer::flush()
+    void align();
+
+    /// @return the number of bits read from the stream
+    uint64_t bits_read() const;
+
+    /// @return the number of bits remaining in the stream
+    uint64_t bits_available() const
+    {
+        return uint64_t(m_size) * 8 - m_position;
+    }
+
+    /// @return the size of the underlying buffer in bytes
+    uint32_t size() const;
+
+private:
+
+    /// Loads the bytes from the specified position to the end of the
+    /// buffer as a big-endian word padded with zero bits
+    /// @param byte the position of the first byte
+    /// @return the loaded word
+    uint64_t load_tail(uint32_t byte) const;
+
+private:
+
+    /// Pointer to the buffer
+    const uint8_t* m_buffer;
+
+    /// The size of the buffer in bytes
+    uint32_t m_size;
+
+    /// The current read position in bits
+    uint64_t m_position;
+};
+}
@@ -0,0 +1,60 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "bit_writer.hpp"
+
+namespace sak
+{
+
+bit_writer::bit_writer(uint8_t* buffer, uint32_t size) :
+    m_buffer(buffer), m_size(size), m_position(0), m_accumulator(0),
+    m_count(0)
+{
+    assert(m_buffer != 0);
+    assert(m_size);
+}
+
+bit_writer::bit_writer(const mutable_storage& storage) :
+    m_buffer(storage.m_data), m_size(storage.m_size), m_position(0),
+    m_accumulator(0), m_count(0)
+{
+    assert(m_buffer != 0);
+    assert(m_size);
+}
+
+void bit_writer::flush()
+{
+    uint32_t bytes = (m_count + 7) / 8;
+
+    // Make sure there is enough space in the underlying buffer
+    assert(m_size >= m_position + bytes);
+
+    for (uint32_t i = 0; i < bytes; ++i)
+    {
+        m_buffer[m_position + i] =
+            static_cast<uint8_t>(m_accumulator >> (56 - 8 * i));
+    }
+
+    m_position += bytes;
+    m_accumulator = 0;
+    m_count = 0;
+}
+
+uint64_t bit_writer::bits_written() const
+{
+    return uint64_t(m_position) * 8 + m_count;
+}
+
+uint32_t bit_writer::bytes_written() const
+{
+    return m_position;
+}
+
+uint32_t bit_writer::size() const
+{
+    return m_size;
+}
+
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "storage.hpp"
+#include "convert_endian.hpp"
+
+namespace sak
+{
+/// The bit_writer packs fields of 1 to 64 bits into a fixed-size buffer.
+/// The fields are written most significant bit first, i.e. the first
+/// field occupies the high bits of the first byte, which matches the
+/// way bit fields are drawn in most protocol specifications.
+///
+/// The fields are collected in a 64-bit accumulator which is written to
+/// the buffer one whole word at a time. Call flush() when all fields
+/// have been written to write out the remaining bits.
+class bit_writer
+{
+public:
+
+    /// Creates a bit writer on top of a pre-allocated buffer of the
+    /// specified size
+    /// @param buffer a pointer to the buffer
+    /// @param size the size of the buffer in bytes
+    bit_writer(uint8_t* buffer, uint32_t size);
+
+    /// Creates a bit writer on top of a mutable storage that has
+    /// a fixed size
+    /// @param storage the mutable storage
+    bit_writer(const mutable_storage& storage);
+
+    /// Writes a field to the stream
+    /// @param value the value to write, must fit in the specified number
+    ///        of bits
+    /// @param bits the width of the field in bits (1 to 64)
+    void write(uint64_t value, uint32_t bits)
+    {
+        assert(bits > 0 && bits <= 64);
+        assert(bits == 64 || (value >> bits) == 0);
+
+        uint32_t free = 64 - m_count;
+
+        if (bits < free)
+        {
+            m_accumulator |= value << (free - bits);
+            m_count += bits;
+            return;
+        }
+
+        // The field completes the accumulator, write out the word and
+        // keep the bits that did not fit
+        m_accumulator |= value >> (bits - free);
+        flush_word();
+
+        m_count = bits - free;
+        m_accumulator = m_count == 0 ? 0 : value << (64 - m_count);
+    }
+
+    /// Writes a number of fields of the same width to the stream
+    /// @param values pointer to the values to write
+    /// @param count the number of values
+    /// @param bits the width of each field in bits (1 to 64)
+    template<class ValueType>
+    void write_array(const ValueType* values, uint32_t count, uint32_t bits)
+    {
+        assert(values != 0 || count == 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            write(static_cast<uint64_t>(values[i]), bits);
+        }
+    }
+
+    /// Writes the bits remaining in the accumulator to the buffer. If
+    /// the number of bits written is not a multiple of eight the last
+    /// byte is padded with zero bits, and writing continues from the
+    /// next byte boundary.
+    void flush();
+
+    /// @return the number of bits written to the stream including the
+    ///         bits not yet flushed
+    uint64_t bits_written() const;
+
+    /// @return the number of bytes written to the buffer, this includes
+    ///         all fields written before the last flush()
+    uint32_t bytes_written() const;
+
+    /// @return the size of the underlying buffer in bytes
+    uint32_t size() const;
+
+private:
+
+    /// Writes the full accumulator to the buffer
+    void flush_word()
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(m_size >= m_position + 8);
+        big_endian::put64(m_accumulator, &m_buffer[m_position]);
+        m_position += 8;
+    }
+
+private:
+
+    /// Pointer to the buffer
+    uint8_t* m_buffer;
+
+    /// The size of the buffer
+    uint32_t m_size;
+
+    /// The position of the next byte to write
+    uint32_t m_position;
+
+    /// The pending bits, left-aligned
+    uint64_t m_accumulator;
+
+    /// The number of pending bits in the accumulator
+    uint32_t m_count;
+};
+}
@@ -5,6 +5,8 @@
 
 #include "buffer_input_stream.hpp"
 
+#include <algorithm>
+
 namespace sak
 {
 buffer_input_stream::buffer_input_stream(
@@ -39,6 +41,25 @@ void buffer_input_stream::read(uint8_t* buffer, uint32_t bytes)
     m_current_pos += bytes;
 }
 
+void buffer_input_stream::read(const mutable_storage* first,
+                               const mutable_storage* last)
+{
+    assert(first <= last);
+    assert(storage_size(first, last) + m_current_pos <=
+           m_buffer_storage.m_size);
+
+    for (; first != last; ++first)
+    {
+        if (first->m_size == 0)
+            continue;
+
+        memcpy(first->m_data, m_buffer_storage.m_data + m_current_pos,
+               first->m_size);
+
+        m_current_pos += first->m_size;
+    }
+}
+
 uint32_t buffer_input_stream::bytes_available()
 {
     return m_buffer_storage.m_size - m_current_pos;
@@ -53,4 +74,16 @@ uint32_t buffer_input_stream::size()
 {
     return m_buffer_storage.m_size;
 }
+
+const_storage buffer_input_stream::peek(uint32_t max_bytes)
+{
+    uint32_t bytes = std::min(max_bytes, bytes_available());
+    return const_storage(m_buffer_storage.m_data + m_current_pos, bytes);
+}
+
+void buffer_input_stream::consume(uint32_t bytes)
+{
+    assert(bytes <= bytes_available());
+    m_current_pos += bytes;
+}
 }
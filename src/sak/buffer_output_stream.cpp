@@ -0,0 +1,39 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "buffer_output_stream.hpp"
+
+#include <algorithm>
+
+namespace sak
+{
+buffer_output_stream::buffer_output_stream(buffer& buffer) :
+    m_buffer(buffer)
+{ }
+
+void buffer_output_stream::write(const uint8_t* buffer, uint32_t bytes)
+{
+    assert(buffer != 0);
+    assert(bytes > 0);
+
+    m_buffer.append(buffer, bytes);
+}
+
+void buffer_output_stream::write(const const_storage* first,
+                                 const const_storage* last)
+{
+    assert(first <= last);
+
+    // Grow the buffer once for the whole sequence
+    uint32_t offset = m_buffer.size();
+    m_buffer.resize(offset + storage_size(first, last));
+
+    for (; first != last; ++first)
+    {
+        std::copy_n(first->m_data, first->m_size, m_buffer.data() + offset);
+        offset += first->m_size;
+    }
+}
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+
+#include "buffer.hpp"
+#include "output_stream.hpp"
+
+namespace sak
+{
+/// Buffer output stream appending the written data to a sak::buffer.
+/// Note that the buffer must be kept "alive" as long as the buffer
+/// output stream is in use.
+class buffer_output_stream : public output_stream
+{
+public:
+
+    /// Constructor
+    /// @param buffer the buffer the data will be appended to
+    buffer_output_stream(buffer& buffer);
+
+public: // From output_stream
+
+    using output_stream::write;
+
+    /// @copydoc output_stream::write(const uint8_t*, uint32_t)
+    void write(const uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc output_stream::write(const const_storage*,
+    ///                               const const_storage*)
+    void write(const const_storage* first, const const_storage* last);
+
+protected:
+
+    /// The buffer
+    buffer& m_buffer;
+};
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "buffered_endian_reader.hpp"
+
+#include <algorithm>
+
+namespace sak
+{
+buffered_endian_reader::buffered_endian_reader(input_stream& stream,
+                                               uint32_t window_size) :
+    m_stream(stream),
+    m_window(window_size),
+    m_position(0),
+    m_end(0),
+    m_offset(0),
+    m_failed(false)
+{
+    // The window must be able to hold the largest varint
+    assert(window_size >= varint::max_size<uint64_t>());
+}
+
+void buffered_endian_reader::read(const mutable_storage& storage)
+{
+    uint32_t buffered = std::min(storage.m_size, m_end - m_position);
+    std::copy_n(&m_window[m_position], buffered, storage.m_data);
+    m_position += buffered;
+
+    uint32_t remaining = storage.m_size - buffered;
+    if (remaining == 0)
+    {
+        return;
+    }
+
+    if (remaining >= m_window.size())
+    {
+        // Large reads bypass the window
+        assert(m_stream.bytes_available() >= remaining);
+        m_stream.read(storage.m_data + buffered, remaining);
+
+        m_offset += m_end + remaining;
+        m_position = 0;
+        m_end = 0;
+        return;
+    }
+
+    fill(remaining);
+    std::copy_n(&m_window[m_position], remaining,
+                storage.m_data + buffered);
+    m_position += remaining;
+}
+
+void buffered_endian_reader::read(const mutable_storage& storage,
+                                  std::error_code& ec)
+{
+    if (m_failed || bytes_available() < storage.m_size)
+    {
+        fail(error::insufficient_data, ec);
+        return;
+    }
+
+    read(storage);
+}
+
+const_storage buffered_endian_reader::read_view(uint32_t size)
+{
+    assert(size <= m_window.size());
+
+    if (m_end - m_position < size)
+    {
+        fill(size);
+    }
+
+    const_storage view(&m_window[m_position], size);
+    m_position += size;
+    return view;
+}
+
+const_storage buffered_endian_reader::read_view(uint32_t size,
+                                               std::error_code& ec)
+{
+    assert(size <= m_window.size());
+
+    if (!buffer(size))
+    {
+        fail(error::insufficient_data, ec);
+        return const_storage();
+    }
+
+    return read_view(size);
+}
+
+void buffered_endian_reader::skip(uint32_t bytes)
+{
+    while (bytes > 0)
+    {
+        if (m_end == m_position)
+        {
+            fill(1);
+        }
+
+        uint32_t step = std::min(bytes, m_end - m_position);
+        m_position += step;
+        bytes -= step;
+    }
+}
+
+void buffered_endian_reader::skip(uint32_t bytes, std::error_code& ec)
+{
+    if (m_failed || bytes_available() < bytes)
+    {
+        fail(error::insufficient_data, ec);
+        return;
+    }
+
+    skip(bytes);
+}
+
+uint32_t buffered_endian_reader::bytes_available()
+{
+    return (m_end - m_position) + m_stream.bytes_available();
+}
+
+uint64_t buffered_endian_reader::position() const
+{
+    return m_offset + m_position;
+}
+
+uint32_t buffered_endian_reader::window_size() const
+{
+    return static_cast<uint32_t>(m_window.size());
+}
+
+void buffered_endian_reader::fill(uint32_t bytes)
+{
+    assert(bytes <= m_window.size());
+
+    refill();
+
+    // Make sure there is enough data to read
+    assert(m_end - m_position >= bytes);
+}
+
+void buffered_endian_reader::refill()
+{
+    // Move the unread bytes to the front of the window
+    uint32_t unread = m_end - m_position;
+    std::copy(m_window.begin() + m_position, m_window.begin() + m_end,
+              m_window.begin());
+
+    m_offset += m_position;
+    m_position = 0;
+    m_end = unread;
+
+    // Read as much as possible to keep the number of reads low
+    uint32_t space = static_cast<uint32_t>(m_window.size()) - m_end;
+    uint32_t read = std::min(space, m_stream.bytes_available());
+
+    if (read > 0)
+    {
+        m_stream.read(&m_window[m_end], read);
+        m_end += read;
+    }
+}
+
+bool buffered_endian_reader::buffer(uint32_t bytes)
+{
+    assert(bytes <= m_window.size());
+
+    if (m_failed)
+        return false;
+
+    if (m_end - m_position < bytes)
+    {
+        refill();
+    }
+
+    return m_end - m_position >= bytes;
+}
+
+uint32_t buffered_endian_reader::decode_varint(uint64_t& value)
+{
+    uint32_t bytes = varint::get(
+        m_window.data() + m_position, m_end - m_position, value);
+
+    // A value not ending in the window may continue in the stream
+    if (bytes == 0 && m_end - m_position < varint::max_size<uint64_t>())
+    {
+        refill();
+        bytes = varint::get(
+            m_window.data() + m_position, m_end - m_position, value);
+    }
+
+    return bytes;
+}
+
+void buffered_endian_reader::fail(error::error_type error,
+                                  std::error_code& ec)
+{
+    ec = error;
+    m_failed = true;
+    m_position = m_end;
+}
+}
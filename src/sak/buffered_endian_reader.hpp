@@ -0,0 +1,298 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include <system_error>
+#include <vector>
+
+#include "convert_endian.hpp"
+#include "error.hpp"
+#include "input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// The buffered_endian_reader provides the read interface of the
+/// sak::endian_stream on top of an input_stream. The data is read from
+/// the input stream in large blocks into an internal window, which makes
+/// it possible to parse large files in constant memory.
+///
+/// Values are decoded directly from the window. When a value crosses the
+/// end of the window, the remaining bytes are moved to the front of the
+/// window before it is refilled. Reads into a storage larger than the
+/// window bypass it and read directly from the input stream.
+///
+/// As for the sak::endian_stream, the read functions only assert that
+/// the data is available, and the overloads taking a std::error_code
+/// should be used for untrusted input. On failure these set the error
+/// code and discard the window, and all following reads with an error
+/// code also fail.
+class buffered_endian_reader
+{
+public:
+
+    /// Creates a reader on top of an input stream
+    /// @param stream the input stream, must outlive the reader
+    /// @param window_size the size in bytes of the internal window, must
+    ///        be larger than the largest value read with read_view()
+    buffered_endian_reader(input_stream& stream,
+                           uint32_t window_size = 65536);
+
+    /// Reads a value from the stream and moves the read position
+    /// @param value reference to the value to be read
+    template<class ValueType>
+    void read(ValueType& value)
+    {
+        if (m_end - m_position < sizeof(ValueType))
+        {
+            fill(sizeof(ValueType));
+        }
+
+        value = big_endian::get<ValueType>(&m_window[m_position]);
+        m_position += sizeof(ValueType);
+    }
+
+    /// Reads a value stored using the specified number of bytes from the
+    /// stream and moves the read position
+    /// @param value reference to the value to be read
+    template<uint32_t Bytes, class ValueType>
+    void read(ValueType& value)
+    {
+        static_assert(Bytes <= sizeof(ValueType),
+                      "The value type is too small for the read");
+
+        if (m_end - m_position < Bytes)
+        {
+            fill(Bytes);
+        }
+
+        value = static_cast<ValueType>(
+            big_endian::get<Bytes>(&m_window[m_position]));
+        m_position += Bytes;
+    }
+
+    /// Reads a varint encoded value from the stream and moves the read
+    /// position
+    /// @param value reference to the value to be read
+    template<class ValueType>
+    void read_varint(ValueType& value)
+    {
+        uint64_t decoded = 0;
+        uint32_t bytes = decode_varint(decoded);
+
+        assert(bytes > 0);
+        assert(decoded <= std::numeric_limits<ValueType>::max());
+
+        value = static_cast<ValueType>(decoded);
+        m_position += bytes;
+    }
+
+    /// Reads a value from the stream and moves the read position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the value
+    template<class ValueType>
+    void read(ValueType& value, std::error_code& ec)
+    {
+        if (!buffer(sizeof(ValueType)))
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read(value);
+    }
+
+    /// Reads a value stored using the specified number of bytes from the
+    /// stream and moves the read position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the value
+    template<uint32_t Bytes, class ValueType>
+    void read(ValueType& value, std::error_code& ec)
+    {
+        if (!buffer(Bytes))
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read<Bytes>(value);
+    }
+
+    /// Reads a varint encoded value from the stream and moves the read
+    /// position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::invalid_varint if the stream does not
+    ///        contain a complete value or the value does not fit in the
+    ///        ValueType
+    template<class ValueType>
+    void read_varint(ValueType& value, std::error_code& ec)
+    {
+        uint64_t decoded = 0;
+        uint32_t bytes = m_failed ? 0 : decode_varint(decoded);
+
+        if (bytes == 0 || decoded > std::numeric_limits<ValueType>::max())
+        {
+            fail(error::invalid_varint, ec);
+            return;
+        }
+
+        value = static_cast<ValueType>(decoded);
+        m_position += bytes;
+    }
+
+    /// Reads an array of values from the stream and moves the read
+    /// position
+    /// @param values pointer to where the values are stored
+    /// @param count the number of values to read
+    template<class ValueType>
+    void read_array(ValueType* values, uint32_t count)
+    {
+        assert(values != 0 || count == 0);
+
+        while (count > 0)
+        {
+            if (m_end - m_position < sizeof(ValueType))
+            {
+                fill(sizeof(ValueType));
+            }
+
+            uint32_t buffered = (m_end - m_position) / sizeof(ValueType);
+            uint32_t chunk = std::min(count, buffered);
+
+            big_endian::get_array<ValueType>(
+                &m_window[m_position], values, chunk);
+
+            m_position += chunk * sizeof(ValueType);
+            values += chunk;
+            count -= chunk;
+        }
+    }
+
+    /// Reads an array of values from the stream and moves the read
+    /// position
+    /// @param values pointer to where the values are stored
+    /// @param count the number of values to read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the values
+    template<class ValueType>
+    void read_array(ValueType* values, uint32_t count, std::error_code& ec)
+    {
+        if (m_failed || bytes_available() / sizeof(ValueType) < count)
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read_array(values, count);
+    }
+
+    /// Reads data from the stream to fill a mutable storage. Note that
+    /// this function does not perform any endian conversions.
+    /// @param storage the storage to be filled
+    void read(const mutable_storage& storage);
+
+    /// Reads data from the stream to fill a mutable storage
+    /// @param storage the storage to be filled
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain enough data to fill the storage
+    void read(const mutable_storage& storage, std::error_code& ec);
+
+    /// Returns a view of the next bytes in the stream and moves the read
+    /// position past them. The view points into the internal window and
+    /// is only valid until the next read.
+    /// @param size the number of bytes in the view, at most the size of
+    ///        the window
+    /// @return storage pointing into the internal window
+    const_storage read_view(uint32_t size);
+
+    /// Returns a view of the next bytes in the stream and moves the read
+    /// position past them
+    /// @param size the number of bytes in the view, at most the size of
+    ///        the window
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain enough data
+    /// @return storage pointing into the internal window, or an empty
+    ///         storage on error
+    const_storage read_view(uint32_t size, std::error_code& ec);
+
+    /// Moves the read position forward
+    /// @param bytes the number of bytes to skip
+    void skip(uint32_t bytes);
+
+    /// Moves the read position forward
+    /// @param bytes the number of bytes to skip
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain enough data
+    void skip(uint32_t bytes, std::error_code& ec);
+
+    /// @return the number of bytes which can be read, i.e. the bytes in
+    ///         the window and the bytes available in the input stream
+    uint32_t bytes_available();
+
+    /// @return the number of bytes read from the reader
+    uint64_t position() const;
+
+    /// @return the size of the internal window in bytes
+    uint32_t window_size() const;
+
+private:
+
+    /// Makes sure that at least the specified number of bytes is in the
+    /// window. The bytes must be available from the input stream.
+    /// @param bytes the number of bytes needed
+    void fill(uint32_t bytes);
+
+    /// Moves the unread bytes to the front of the window and fills the
+    /// rest of it with the bytes available from the input stream
+    void refill();
+
+    /// Tries to get at least the specified number of bytes into the
+    /// window
+    /// @param bytes the number of bytes needed, at most the window size
+    /// @return true if the bytes are in the window, false if the stream
+    ///         does not have them or the reader has failed
+    bool buffer(uint32_t bytes);
+
+    /// Decodes the varint at the read position without moving it. The
+    /// window is only refilled if the value continues past its end.
+    /// @param value the decoded value
+    /// @return the size of the value, or zero if the stream does not
+    ///         contain a complete value
+    uint32_t decode_varint(uint64_t& value);
+
+    /// Marks the reader as failed by setting the error code and
+    /// discarding the window
+    /// @param error the error that occurred
+    /// @param ec the error code to set
+    void fail(error::error_type error, std::error_code& ec);
+
+private:
+
+    /// The input stream
+    input_stream& m_stream;
+
+    /// The internal window
+    std::vector<uint8_t> m_window;
+
+    /// The read position in the window
+    uint32_t m_position;
+
+    /// The end of the valid data in the window
+    uint32_t m_end;
+
+    /// The number of bytes consumed before the start of the window
+    uint64_t m_offset;
+
+    /// True if a read with an error code has failed
+    bool m_failed;
+};
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "content_chunk_reader.hpp"
+
+namespace sak
+{
+content_chunk_reader::content_chunk_reader(input_stream& stream,
+                                           const content_chunker& chunker) :
+    m_stream(stream),
+    m_chunker(chunker),
+    m_pending(0),
+    m_bytes_read(0)
+{ }
+
+bool content_chunk_reader::read(const_storage& chunk)
+{
+    if (m_pending > 0)
+    {
+        m_stream.consume(m_pending);
+        m_pending = 0;
+    }
+
+    // Read stopped() before peeking, so no data can arrive in between
+    bool stopped = m_stream.stopped();
+    const_storage data = m_stream.peek(m_chunker.max_size());
+
+    if (data.m_size == 0)
+        return false;
+
+    // Without max_size bytes the boundary could move when more data
+    // arrives
+    if (data.m_size < m_chunker.max_size() && !stopped)
+        return false;
+
+    m_pending = m_chunker.next_boundary(data);
+    m_bytes_read += m_pending;
+
+    chunk = const_storage(data.m_data, m_pending);
+    return true;
+}
+
+uint64_t content_chunk_reader::bytes_read() const
+{
+    return m_bytes_read;
+}
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+
+#include "content_chunker.hpp"
+#include "input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// The content_chunk_reader cuts the data of an input_stream into
+/// content-defined chunks using a sak::content_chunker. The chunks are
+/// the same as those found by content_chunker::split() on the whole
+/// data.
+///
+/// The data is accessed using input_stream::peek(), so streams holding
+/// their data in memory are chunked without copying. A chunk is only
+/// cut when max_size bytes are available or the stream has stopped, so
+/// a live stream can be read whenever new data is ready.
+///
+/// Example:
+///
+///     sak::content_chunk_reader reader(stream, chunker);
+///     sak::const_storage chunk;
+///
+///     while (reader.read(chunk))
+///     {
+///         store(hash(chunk), chunk);
+///     }
+///
+class content_chunk_reader
+{
+public:
+
+    /// Creates a reader on top of an input stream
+    /// @param stream the input stream, must outlive the reader
+    /// @param chunker the chunker, must outlive the reader
+    content_chunk_reader(input_stream& stream,
+                         const content_chunker& chunker);
+
+    /// Reads the next chunk from the stream. The chunk is valid until the
+    /// next call to read() and the stream must not be used in the mean
+    /// time.
+    /// @param chunk set to the next chunk
+    /// @return false if no chunk can be cut from the data available, for
+    ///         a stopped stream this means that all data has been read
+    bool read(const_storage& chunk);
+
+    /// @return the number of bytes returned in chunks
+    uint64_t bytes_read() const;
+
+private:
+
+    /// The input stream
+    input_stream& m_stream;
+
+    /// The chunker
+    const content_chunker& m_chunker;
+
+    /// The size of the last chunk, which is consumed on the next read
+    uint32_t m_pending;
+
+    /// The number of bytes returned in chunks
+    uint64_t m_bytes_read;
+};
+}
@@ -0,0 +1,116 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "content_chunker.hpp"
+
+namespace sak
+{
+namespace
+{
+/// The tables of random values used by the Gear hash
+struct gear_tables
+{
+    gear_tables()
+    {
+        // Fill the table using splitmix64 with a fixed seed, so the
+        // boundaries are the same on all platforms
+        uint64_t state = 0;
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            state += 0x9E3779B97F4A7C15ULL;
+
+            uint64_t value = state;
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            value = value ^ (value >> 31);
+
+            m_gear[i] = value;
+            m_gear_shifted[i] = value << 1;
+        }
+    }
+
+    /// The Gear table
+    uint64_t m_gear[256];
+
+    /// The Gear table shifted by one bit
+    uint64_t m_gear_shifted[256];
+};
+
+const gear_tables& tables()
+{
+    static const gear_tables instance;
+    return instance;
+}
+
+/// Creates a mask with the specified number of bits set, below the top
+/// bit where the fingerprint depends on the most bytes
+uint64_t make_mask(uint32_t bits)
+{
+    assert(bits > 0 && bits < 63);
+    return ((uint64_t(1) << bits) - 1) << (63 - bits);
+}
+}
+
+content_chunker::content_chunker(uint32_t min_size, uint32_t average_size,
+                                 uint32_t max_size) :
+    m_min_size(min_size),
+    m_average_size(average_size),
+    m_max_size(max_size),
+    m_mask_small(0),
+    m_mask_large(0),
+    m_gear(tables().m_gear),
+    m_gear_shifted(tables().m_gear_shifted)
+{
+    assert(m_average_size >= 8);
+    assert(m_min_size <= m_average_size);
+    assert(m_average_size <= m_max_size);
+
+    uint32_t bits = 0;
+    while ((uint64_t(1) << (bits + 1)) <= m_average_size)
+    {
+        ++bits;
+    }
+
+    // Normalization level two as suggested by FastCDC
+    m_mask_small = make_mask(bits + 2);
+    m_mask_large = make_mask(bits - 2);
+}
+
+std::vector<const_storage>
+content_chunker::split(const const_storage& data) const
+{
+    std::vector<const_storage> chunks;
+
+    const uint8_t* position = data.m_data;
+    uint32_t remaining = data.m_size;
+
+    while (remaining > 0)
+    {
+        uint32_t size = next_boundary(position, remaining);
+        chunks.push_back(const_storage(position, size));
+
+        position += size;
+        remaining -= size;
+    }
+
+    return chunks;
+}
+
+uint32_t content_chunker::min_size() const
+{
+    return m_min_size;
+}
+
+uint32_t content_chunker::average_size() const
+{
+    return m_average_size;
+}
+
+uint32_t content_chunker::max_size() const
+{
+    return m_max_size;
+}
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <vector>
+
+#include "storage.hpp"
+
+namespace sak
+{
+/// The content_chunker finds content-defined chunk boundaries using the
+/// Gear rolling hash with the normalized chunking of FastCDC. Since a
+/// boundary only depends on the bytes just before it, inserting or
+/// removing data only changes the chunks around the modification, unlike
+/// the fixed-size splits of sak::split_storage().
+///
+/// No boundary is placed before min_size bytes, a stricter mask is used
+/// until average_size bytes and a looser mask until max_size bytes,
+/// where a boundary is always placed. This keeps the chunk sizes close
+/// to the average.
+///
+/// The fingerprint is rolled two bytes per step using a second table
+/// holding the Gear values shifted by one bit. This halves the number of
+/// shifts on the dependency chain of the hash while finding exactly the
+/// same boundaries as rolling one byte at a time.
+///
+/// Example:
+///
+///     sak::content_chunker chunker(2048, 8192, 65536);
+///
+///     for (const auto& chunk : chunker.split(sak::storage(data)))
+///     {
+///         store(hash(chunk), chunk);
+///     }
+///
+class content_chunker
+{
+public:
+
+    /// Constructor
+    /// @param min_size the minimum size of a chunk in bytes
+    /// @param average_size the average size of a chunk in bytes, must be
+    ///        at least 8, the masks are derived from the largest power
+    ///        of two not above it
+    /// @param max_size the maximum size of a chunk in bytes
+    content_chunker(uint32_t min_size, uint32_t average_size,
+                    uint32_t max_size);
+
+    /// Finds the end of the first chunk in a buffer. If the buffer
+    /// contains less than max_size bytes it is assumed to end the data,
+    /// so when data arrives incrementally at least max_size bytes should
+    /// be passed until the end of the data.
+    /// @param data pointer to the data
+    /// @param size the size of the data in bytes
+    /// @return the size of the first chunk
+    uint32_t next_boundary(const uint8_t* data, uint32_t size) const
+    {
+        assert(data != 0 || size == 0);
+
+        if (size <= m_min_size)
+            return size;
+
+        uint32_t end = std::min(size, m_max_size);
+        uint32_t normal = std::min(end, m_average_size);
+
+        uint32_t position = m_min_size;
+        uint64_t fingerprint = 0;
+
+        if (roll(data, normal, m_mask_small, position, fingerprint))
+            return position;
+
+        roll(data, end, m_mask_large, position, fingerprint);
+        return position;
+    }
+
+    /// @copydoc next_boundary(const uint8_t*, uint32_t) const
+    /// @param data the data
+    uint32_t next_boundary(const const_storage& data) const
+    {
+        return next_boundary(data.m_data, data.m_size);
+    }
+
+    /// Splits a buffer into content-defined chunks
+    /// @param data the data to split
+    /// @return the chunks pointing into the buffer
+    std::vector<const_storage> split(const const_storage& data) const;
+
+    /// @return the minimum size of a chunk
+    uint32_t min_size() const;
+
+    /// @return the average size of a chunk
+    uint32_t average_size() const;
+
+    /// @return the maximum size of a chunk
+    uint32_t max_size() const;
+
+private:
+
+    /// Rolls the fingerprint over the data from position to end
+    /// @param data pointer to the data
+    /// @param end the position to stop at
+    /// @param mask the mask selecting the fingerprint bits which must be
+    ///        zero at a boundary, the top bit must not be set
+    /// @param position the current position, on return the position of
+    ///        the boundary or end
+    /// @param fingerprint the rolling fingerprint
+    /// @return true if a boundary was found
+    bool roll(const uint8_t* data, uint32_t end, uint64_t mask,
+              uint32_t& position, uint64_t& fingerprint) const
+    {
+        // The first byte of a pair is added shifted by one bit, so the
+        // fingerprint is shifted by one bit when the mask is checked
+        uint64_t mask_shifted = mask << 1;
+
+        uint32_t i = position;
+        uint64_t hash = fingerprint;
+
+        for (; i + 2 <= end; i += 2)
+        {
+            hash = (hash << 2) + m_gear_shifted[data[i]];
+
+            if ((hash & mask_shifted) == 0)
+            {
+                position = i + 1;
+                return true;
+            }
+
+            hash += m_gear[data[i + 1]];
+
+            if ((hash & mask) == 0)
+            {
+                position = i + 2;
+                return true;
+            }
+        }
+
+        if (i < end)
+        {
+            hash = (hash << 1) + m_gear[data[i]];
+            ++i;
+
+            if ((hash & mask) == 0)
+            {
+                position = i;
+                return true;
+            }
+        }
+
+        position = i;
+        fingerprint = hash;
+        return false;
+    }
+
+private:
+
+    /// The minimum size of a chunk
+    uint32_t m_min_size;
+
+    /// The average size of a chunk
+    uint32_t m_average_size;
+
+    /// The maximum size of a chunk
+    uint32_t m_max_size;
+
+    /// The mask used before the average size
+    uint64_t m_mask_small;
+
+    /// The mask used after the average size
+    uint64_t m_mask_large;
+
+    /// The Gear table
+    const uint64_t* m_gear;
+
+    /// The Gear table shifted by one bit
+    const uint64_t* m_gear_shifted;
+};
+}
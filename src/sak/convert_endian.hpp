@@ -7,9 +7,30 @@
 
 #include <cstdint>
 #include <cassert>
+#include <cstring>
+#include <limits>
 
 namespace sak
 {
+// Do not expose implementation details to users of this header file
+namespace detail
+{
+/// Reinterprets the bits of a value as another type of the same size
+/// @param value the value to reinterpret
+/// @return the value with the same bit pattern
+template<class To, class From>
+inline To copy_bits(From value)
+{
+    static_assert(sizeof(To) == sizeof(From), "The sizes must match");
+
+    // Copy the bit pattern, this is the only well-defined way to
+    // reinterpret the value and compiles to a register move
+    To result;
+    std::memcpy(&result, &value, sizeof(result));
+    return result;
+}
+}
+
 // Inserts and extracts integers in big-endian format.
 struct big_endian
 {
@@ -17,10 +38,10 @@ struct big_endian
     /// convenience in the template-based getters and putters.
     /// @param buffer pointer to the byte stream buffer
     /// @return retrieved value from the byte stream
-    static uint8_t get8(const uint8_t* buffer)
+    static constexpr uint8_t get8(const uint8_t* buffer)
     {
-        assert(buffer != 0);
-        return *buffer;
+        return assert(buffer != 0),
+               *buffer;
     }
 
     /// Inserts an 8-bit value integer into the byte stream. Only exists
@@ -36,10 +57,10 @@ struct big_endian
     /// Gets a 16-bit value integer which is in big-endian format from
     /// a byte stream.
     /// @copydetails get8()
-    static uint16_t get16(const uint8_t* buffer)
+    static constexpr uint16_t get16(const uint8_t* buffer)
     {
-        assert(buffer != 0);
-        return (buffer[0] << 8) | buffer[1];
+        return assert(buffer != 0),
+               (uint16_t(buffer[0]) << 8) | buffer[1];
     }
 
     /// Inserts a 16-bit value into a byte stream in big-endian format.
@@ -55,11 +76,31 @@ struct big_endian
     /// Gets a 32-bit value integer which is in big-endian format from a
     /// byte stream.
     /// @copydetails get8()
-    static uint32_t get32(const uint8_t* buffer)
+    static constexpr uint32_t get32(const uint8_t* buffer)
+    {
+        return assert(buffer != 0),
+               (uint32_t(buffer[0]) << 24) | (uint32_t(buffer[1]) << 16) |
+               (uint32_t(buffer[2]) << 8)  | buffer[3];
+    }
+
+    /// Gets a 24-bit value integer which is in big-endian format from a
+    /// byte stream.
+    /// @copydetails get8()
+    static constexpr uint32_t get24(const uint8_t* buffer)
+    {
+        return assert(buffer != 0),
+               (uint32_t(get16(buffer)) << 8) | buffer[2];
+    }
+
+    /// Inserts a 24-bit value into a byte stream in big-endian format.
+    /// @copydetails put8()
+    static void put24(uint32_t value, uint8_t* buffer)
     {
         assert(buffer != 0);
-        return (buffer[0] << 24) | (buffer[1] << 16) |
-               (buffer[2] << 8)  | buffer[3];
+        assert(value <= 0xFFFFFFU);
+
+        put16(static_cast<uint16_t>(value >> 8), buffer);
+        buffer[2] = (value & 0xFF);
     }
 
     /// Inserts a 32-bit value into a byte stream in big-endian format.
@@ -77,10 +118,10 @@ struct big_endian
     /// Gets a 64-bit value integer which is in big-endian format from a
     /// byte stream.
     /// @copydetails get8()
-    static uint64_t get64(const uint8_t* buffer)
+    static constexpr uint64_t get64(const uint8_t* buffer)
     {
-        assert(buffer != 0);
-        return (((uint64_t) buffer[0]) << 56) |
+        return assert(buffer != 0),
+               (((uint64_t) buffer[0]) << 56) |
                (((uint64_t) buffer[1]) << 48) |
                (((uint64_t) buffer[2]) << 40) |
                (((uint64_t) buffer[3]) << 32) |
@@ -106,6 +147,70 @@ struct big_endian
         buffer[0] = ((value >> 56) & 0xFF);
     }
 
+    /// Gets a 40-bit value integer which is in big-endian format from a
+    /// byte stream.
+    /// @copydetails get8()
+    static constexpr uint64_t get40(const uint8_t* buffer)
+    {
+        return assert(buffer != 0),
+               (uint64_t(get32(buffer)) << 8) | buffer[4];
+    }
+
+    /// Inserts a 40-bit value into a byte stream in big-endian format.
+    /// @copydetails put8()
+    static void put40(uint64_t value, uint8_t* buffer)
+    {
+        assert(buffer != 0);
+        assert(value <= 0xFFFFFFFFFFULL);
+
+        put32(static_cast<uint32_t>(value >> 8), buffer);
+        buffer[4] = (value & 0xFF);
+    }
+
+    /// Gets a 48-bit value integer which is in big-endian format from a
+    /// byte stream.
+    /// @copydetails get8()
+    static constexpr uint64_t get48(const uint8_t* buffer)
+    {
+        return assert(buffer != 0),
+               (uint64_t(get32(buffer)) << 16) | get16(buffer + 4);
+    }
+
+    /// Inserts a 48-bit value into a byte stream in big-endian format.
+    /// @copydetails put8()
+    static void put48(uint64_t value, uint8_t* buffer)
+    {
+        assert(buffer != 0);
+        assert(value <= 0xFFFFFFFFFFFFULL);
+
+        put32(static_cast<uint32_t>(value >> 16), buffer);
+        put16(static_cast<uint16_t>(value), buffer + 4);
+    }
+
+    /// Gets a 56-bit value integer which is in big-endian format from a
+    /// byte stream. The value is read using two overlapping 32-bit loads
+    /// which both stay within the seven bytes of the value.
+    /// @copydetails get8()
+    static constexpr uint64_t get56(const uint8_t* buffer)
+    {
+        return assert(buffer != 0),
+               (uint64_t(get32(buffer)) << 24) |
+               (get32(buffer + 3) & 0xFFFFFFU);
+    }
+
+    /// Inserts a 56-bit value into a byte stream in big-endian format.
+    /// The value is written using two overlapping 32-bit stores, the
+    /// shared byte gets the same value from both stores.
+    /// @copydetails put8()
+    static void put56(uint64_t value, uint8_t* buffer)
+    {
+        assert(buffer != 0);
+        assert(value <= 0xFFFFFFFFFFFFFFULL);
+
+        put32(static_cast<uint32_t>(value >> 24), buffer);
+        put32(static_cast<uint32_t>(value), buffer + 3);
+    }
+
     /// Template based put and get functions, the main reason for these is
     /// to allow generic code to be written where the "right" get/put
     /// function will be called based on the template parameter
@@ -114,6 +219,52 @@ struct big_endian
 
     template<class ValueType>
     static ValueType get(const uint8_t* buffer);
+
+    /// Template based put and get functions selecting the codec based on
+    /// the number of bytes used in the stream, e.g. put<3>() will call
+    /// put24(). The values are passed as 64-bit integers.
+    template<uint32_t Bytes>
+    static void put(uint64_t value, uint8_t* buffer);
+
+    template<uint32_t Bytes>
+    static uint64_t get(const uint8_t* buffer);
+
+    /// Inserts an array of values into a byte stream in big-endian
+    /// format. The loop body has no dependencies between the elements
+    /// which allows the compiler to vectorize the conversion.
+    /// @param values pointer to the values to put in the stream
+    /// @param count the number of values
+    /// @param buffer pointer to the byte stream buffer
+    template<class ValueType>
+    static void put_array(const ValueType* values, uint32_t count,
+                          uint8_t* buffer)
+    {
+        assert(values != 0 || count == 0);
+        assert(buffer != 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            put<ValueType>(values[i], buffer + i * sizeof(ValueType));
+        }
+    }
+
+    /// Gets an array of values which are in big-endian format from a byte
+    /// stream.
+    /// @param buffer pointer to the byte stream buffer
+    /// @param values pointer to where the retrieved values are stored
+    /// @param count the number of values
+    template<class ValueType>
+    static void get_array(const uint8_t* buffer, ValueType* values,
+                          uint32_t count)
+    {
+        assert(buffer != 0);
+        assert(values != 0 || count == 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            values[i] = get<ValueType>(buffer + i * sizeof(ValueType));
+        }
+    }
 };
 
 template<>
@@ -141,26 +292,424 @@ inline void big_endian::put<uint64_t>(uint64_t value, uint8_t* buffer)
 }
 
 template<>
-inline uint8_t big_endian::get<uint8_t>(const uint8_t* buffer)
+inline constexpr uint8_t big_endian::get<uint8_t>(const uint8_t* buffer)
 {
     return big_endian::get8(buffer);
 }
 
 template<>
-inline uint16_t big_endian::get<uint16_t>(const uint8_t* buffer)
+inline constexpr uint16_t big_endian::get<uint16_t>(const uint8_t* buffer)
 {
     return big_endian::get16(buffer);
 }
 
 template<>
-inline uint32_t big_endian::get<uint32_t>(const uint8_t* buffer)
+inline constexpr uint32_t big_endian::get<uint32_t>(const uint8_t* buffer)
 {
     return big_endian::get32(buffer);
 }
 
 template<>
-inline uint64_t big_endian::get<uint64_t>(const uint8_t* buffer)
+inline constexpr uint64_t big_endian::get<uint64_t>(const uint8_t* buffer)
 {
     return big_endian::get64(buffer);
 }
+
+template<>
+inline void big_endian::put<int8_t>(int8_t value, uint8_t* buffer)
+{
+    big_endian::put8(static_cast<uint8_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<int16_t>(int16_t value, uint8_t* buffer)
+{
+    big_endian::put16(static_cast<uint16_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<int32_t>(int32_t value, uint8_t* buffer)
+{
+    big_endian::put32(static_cast<uint32_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<int64_t>(int64_t value, uint8_t* buffer)
+{
+    big_endian::put64(static_cast<uint64_t>(value), buffer);
+}
+
+template<>
+inline constexpr int8_t big_endian::get<int8_t>(const uint8_t* buffer)
+{
+    return static_cast<int8_t>(big_endian::get8(buffer));
+}
+
+template<>
+inline constexpr int16_t big_endian::get<int16_t>(const uint8_t* buffer)
+{
+    return static_cast<int16_t>(big_endian::get16(buffer));
+}
+
+template<>
+inline constexpr int32_t big_endian::get<int32_t>(const uint8_t* buffer)
+{
+    return static_cast<int32_t>(big_endian::get32(buffer));
+}
+
+template<>
+inline constexpr int64_t big_endian::get<int64_t>(const uint8_t* buffer)
+{
+    return static_cast<int64_t>(big_endian::get64(buffer));
+}
+
+template<>
+inline void big_endian::put<float>(float value, uint8_t* buffer)
+{
+    big_endian::put32(detail::copy_bits<uint32_t>(value), buffer);
+}
+
+template<>
+inline float big_endian::get<float>(const uint8_t* buffer)
+{
+    return detail::copy_bits<float>(big_endian::get32(buffer));
+}
+
+template<>
+inline void big_endian::put<double>(double value, uint8_t* buffer)
+{
+    big_endian::put64(detail::copy_bits<uint64_t>(value), buffer);
+}
+
+template<>
+inline double big_endian::get<double>(const uint8_t* buffer)
+{
+    return detail::copy_bits<double>(big_endian::get64(buffer));
+}
+
+template<>
+inline void big_endian::put<1>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put8(static_cast<uint8_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<2>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put16(static_cast<uint16_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<3>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put24(static_cast<uint32_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<4>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put32(static_cast<uint32_t>(value), buffer);
+}
+
+template<>
+inline void big_endian::put<5>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put40(value, buffer);
+}
+
+template<>
+inline void big_endian::put<6>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put48(value, buffer);
+}
+
+template<>
+inline void big_endian::put<7>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put56(value, buffer);
+}
+
+template<>
+inline void big_endian::put<8>(uint64_t value, uint8_t* buffer)
+{
+    big_endian::put64(value, buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<1>(const uint8_t* buffer)
+{
+    return big_endian::get8(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<2>(const uint8_t* buffer)
+{
+    return big_endian::get16(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<3>(const uint8_t* buffer)
+{
+    return big_endian::get24(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<4>(const uint8_t* buffer)
+{
+    return big_endian::get32(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<5>(const uint8_t* buffer)
+{
+    return big_endian::get40(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<6>(const uint8_t* buffer)
+{
+    return big_endian::get48(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<7>(const uint8_t* buffer)
+{
+    return big_endian::get56(buffer);
+}
+
+template<>
+inline constexpr uint64_t big_endian::get<8>(const uint8_t* buffer)
+{
+    return big_endian::get64(buffer);
+}
+
+/// Inserts and extracts unsigned integers using the variable-length
+/// LEB128 encoding. Each byte carries 7 bits of the value starting with
+/// the least significant group, and the high bit of a byte is set if
+/// more bytes follow. Small values therefore only occupy a single byte.
+struct varint
+{
+    /// @return the maximum number of bytes needed to encode a value of
+    ///         the specified type
+    template<class ValueType>
+    static uint32_t max_size()
+    {
+        return (sizeof(ValueType) * 8 + 6) / 7;
+    }
+
+    /// @param value the value to be encoded
+    /// @return the number of bytes needed to encode the value
+    static uint32_t size(uint64_t value)
+    {
+        uint32_t bytes = 1;
+        while (value >= 0x80)
+        {
+            value >>= 7;
+            ++bytes;
+        }
+        return bytes;
+    }
+
+    /// Inserts a value into a byte stream. The buffer must have room for
+    /// at least size(value) bytes.
+    /// @param value to put in the stream
+    /// @param buffer pointer to the byte stream buffer
+    /// @return the number of bytes written
+    static uint32_t put(uint64_t value, uint8_t* buffer)
+    {
+        assert(buffer != 0);
+
+        uint8_t* current = buffer;
+        while (value >= 0x80)
+        {
+            *current++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *current++ = static_cast<uint8_t>(value);
+
+        return static_cast<uint32_t>(current - buffer);
+    }
+
+    /// Gets a value from a byte stream.
+    /// @param buffer pointer to the byte stream buffer
+    /// @param size the number of bytes available in the buffer
+    /// @param value the retrieved value
+    /// @return the number of bytes read, or zero if the buffer does not
+    ///         contain a complete encoding of a 64-bit value
+    static uint32_t get(const uint8_t* buffer, uint32_t size, uint64_t& value)
+    {
+        assert(buffer != 0);
+
+        uint32_t limit = size < max_size<uint64_t>() ?
+            size : max_size<uint64_t>();
+
+        uint64_t result = 0;
+        for (uint32_t i = 0; i < limit; ++i)
+        {
+            // The tenth byte only carries the most significant bit
+            if (i == max_size<uint64_t>() - 1 && buffer[i] > 0x01)
+                return 0;
+
+            result |= uint64_t(buffer[i] & 0x7F) << (7 * i);
+
+            if ((buffer[i] & 0x80) == 0)
+            {
+                value = result;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    /// Encodes a sequence of values into a byte stream. The buffer must
+    /// have room for at least count * max_size<ValueType>() bytes, or the
+    /// sum of size() for every value.
+    /// @param values pointer to the values to encode
+    /// @param count the number of values
+    /// @param buffer pointer to the byte stream buffer
+    /// @return the number of bytes written
+    template<class ValueType>
+    static uint32_t put_batch(const ValueType* values, uint32_t count,
+                              uint8_t* buffer)
+    {
+        assert(values != 0 || count == 0);
+        assert(buffer != 0);
+
+        uint8_t* current = buffer;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            current += put(values[i], current);
+        }
+        return static_cast<uint32_t>(current - buffer);
+    }
+
+    /// Decodes a sequence of values from a byte stream. While at least
+    /// eight bytes remain in the buffer the decoder works on whole 64-bit
+    /// words: a word without any continuation bits yields eight values at
+    /// once, and otherwise the length of the next value is found from the
+    /// continuation bits and its 7-bit groups are compacted with a fixed
+    /// sequence of masks and shifts instead of a per-byte loop.
+    /// @param buffer pointer to the byte stream buffer
+    /// @param size the number of bytes available in the buffer
+    /// @param values pointer to where the decoded values are stored
+    /// @param count the number of values to decode
+    /// @return the number of bytes read, or zero if the buffer does not
+    ///         contain count complete values that fit in ValueType
+    template<class ValueType>
+    static uint32_t get_batch(const uint8_t* buffer, uint32_t size,
+                              ValueType* values, uint32_t count)
+    {
+        assert(buffer != 0);
+        assert(values != 0 || count == 0);
+
+        const uint64_t max_value = std::numeric_limits<ValueType>::max();
+        const uint64_t high_bits = 0x8080808080808080ULL;
+
+        const uint8_t* current = buffer;
+        const uint8_t* end = buffer + size;
+        uint32_t i = 0;
+
+        while (i < count && end - current >= 8)
+        {
+            uint64_t word = load_little_endian64(current);
+            uint64_t stops = ~word & high_bits;
+
+            if (stops == high_bits && count - i >= 8)
+            {
+                // Eight single-byte values
+                for (uint32_t j = 0; j < 8; ++j)
+                {
+                    values[i + j] = static_cast<ValueType>(current[j]);
+                }
+                i += 8;
+                current += 8;
+                continue;
+            }
+
+            if (stops == 0)
+            {
+                // The value is longer than eight bytes
+                uint64_t value = 0;
+                uint32_t bytes =
+                    get(current, static_cast<uint32_t>(end - current), value);
+
+                if (bytes == 0 || value > max_value)
+                    return 0;
+
+                values[i++] = static_cast<ValueType>(value);
+                current += bytes;
+                continue;
+            }
+
+            uint32_t bytes = lowest_set_byte(stops) + 1;
+
+            // Keep only the bytes belonging to this value and compact
+            // the 7-bit groups into a contiguous integer
+            uint64_t value = word & (~0ULL >> (64 - 8 * bytes));
+            value = ((value & 0x7F007F007F007F00ULL) >> 1) |
+                    (value & 0x007F007F007F007FULL);
+            value = ((value & 0x3FFF00003FFF0000ULL) >> 2) |
+                    (value & 0x00003FFF00003FFFULL);
+            value = ((value & 0x0FFFFFFF00000000ULL) >> 4) |
+                    (value & 0x000000000FFFFFFFULL);
+
+            if (value > max_value)
+                return 0;
+
+            values[i++] = static_cast<ValueType>(value);
+            current += bytes;
+        }
+
+        // Decode the tail of the buffer one value at a time
+        for (; i < count; ++i)
+        {
+            uint64_t value = 0;
+            uint32_t bytes =
+                get(current, static_cast<uint32_t>(end - current), value);
+
+            if (bytes == 0 || value > max_value)
+                return 0;
+
+            values[i] = static_cast<ValueType>(value);
+            current += bytes;
+        }
+
+        return static_cast<uint32_t>(current - buffer);
+    }
+
+private:
+
+    /// Loads eight bytes in little-endian order, most compilers turn
+    /// this into a single load on little-endian hosts.
+    static uint64_t load_little_endian64(const uint8_t* buffer)
+    {
+        return ((uint64_t) buffer[0]) |
+               (((uint64_t) buffer[1]) << 8) |
+               (((uint64_t) buffer[2]) << 16) |
+               (((uint64_t) buffer[3]) << 24) |
+               (((uint64_t) buffer[4]) << 32) |
+               (((uint64_t) buffer[5]) << 40) |
+               (((uint64_t) buffer[6]) << 48) |
+               (((uint64_t) buffer[7]) << 56);
+    }
+
+    /// @param bits a non-zero value where only the high bit of each byte
+    ///        may be set
+    /// @return the index of the lowest byte with its high bit set
+    static uint32_t lowest_set_byte(uint64_t bits)
+    {
+        assert(bits != 0);
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctzll(bits)) / 8;
+#else
+        uint32_t index = 0;
+        while ((bits & 0x80) == 0)
+        {
+            bits >>= 8;
+            ++index;
+        }
+        return index;
+#endif
+    }
+};
 }
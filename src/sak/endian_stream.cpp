@@ -22,6 +22,11 @@ endian_stream::endian_stream(const mutable_storage& storage) :
     assert(m_size);
 }
 
+uint8_t* endian_stream::data() const
+{
+    return m_buffer;
+}
+
 uint32_t endian_stream::size() const
 {
     return m_size;
@@ -32,10 +37,21 @@ uint32_t endian_stream::position() const
     return m_position;
 }
 
+uint32_t endian_stream::remaining_size() const
+{
+    return m_size - m_position;
+}
+
 void endian_stream::seek(uint32_t new_position)
 {
     assert(new_position <= m_size);
     m_position = new_position;
 }
 
+void endian_stream::fail(error::error_type error, std::error_code& ec)
+{
+    ec = error;
+    m_position = m_size;
+}
+
 }
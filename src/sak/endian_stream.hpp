@@ -8,15 +8,31 @@
 #include <stdint.h>
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <vector>
 
 #include "storage.hpp"
 #include "convert_endian.hpp"
+#include "error.hpp"
+#include "reserved_field.hpp"
 
 namespace sak
 {
 /// The idea behind the endian_stream is to provide a stream-like interface
 /// for accessing a fixed-size buffer.
 /// All complexity regarding endianness is encapsulated.
+///
+/// The read and write functions only assert that the buffer is large
+/// enough. When parsing untrusted input the overloads taking a
+/// std::error_code should be used instead. These check the bounds with
+/// a single comparison and on failure set the error code and move the
+/// position to the end of the stream, so all following reads and writes
+/// also fail. A sequence of fields can therefore be read and the error
+/// code checked once at the end. Alternatively, remaining_size() can be
+/// used to validate the size of a whole header up front, after which the
+/// unchecked functions can be used.
 class endian_stream
 {
 public:
@@ -45,6 +61,36 @@ public:
         m_position += sizeof(ValueType);
     }
 
+    /// Writes a value using the specified number of bytes to the stream,
+    /// e.g. write<3>() writes a 24-bit value
+    /// @param value the value to write
+    template<uint32_t Bytes>
+    void write(uint64_t value)
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(m_size >= m_position + Bytes);
+        // Write the value at the current position
+        big_endian::put<Bytes>(value, &m_buffer[m_position]);
+        // Advance the current position
+        m_position += Bytes;
+    }
+
+    /// Writes an array of values to the stream. Note that the number of
+    /// values is not written to the stream.
+    /// @param values pointer to the values to write
+    /// @param count the number of values
+    template<class ValueType>
+    void write_array(const ValueType* values, uint32_t count)
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(m_size >= m_position + count * sizeof(ValueType));
+        // Write the values at the current position
+        big_endian::put_array<ValueType>(values, count,
+                                         &m_buffer[m_position]);
+        // Advance the current position
+        m_position += count * sizeof(ValueType);
+    }
+
     /// Writes the contents of a sak::storage container to the stream.
     /// Note that this function is provided only for convenience and
     /// it does not perform any endian conversions. Furthermore, the length
@@ -83,6 +129,41 @@ public:
         m_position += sizeof(ValueType);
     }
 
+    /// Reads a value stored using the specified number of bytes from the
+    /// stream and moves the read position, e.g. read<3>() reads a 24-bit
+    /// value
+    /// @param value reference to the value to be read
+    template<uint32_t Bytes, class ValueType>
+    void read(ValueType& value)
+    {
+        static_assert(Bytes <= sizeof(ValueType),
+                      "The value type is too small for the read");
+
+        // Make sure there is enough data to read in the underlying buffer
+        assert(m_size >= m_position + Bytes);
+        // Read the value at the current position
+        value = static_cast<ValueType>(
+            big_endian::get<Bytes>(&m_buffer[m_position]));
+        // Advance the current position
+        m_position += Bytes;
+    }
+
+    /// Reads an array of values from the stream and moves the read
+    /// position.
+    /// @param values pointer to where the values are stored
+    /// @param count the number of values to read
+    template<class ValueType>
+    void read_array(ValueType* values, uint32_t count)
+    {
+        // Make sure there is enough data to read in the underlying buffer
+        assert(m_size >= m_position + count * sizeof(ValueType));
+        // Read the values at the current position
+        big_endian::get_array<ValueType>(&m_buffer[m_position], values,
+                                         count);
+        // Advance the current position
+        m_position += count * sizeof(ValueType);
+    }
+
     /// Reads data from the stream to fill a mutable storage
     /// Note that this function is provided only for convenience and
     /// it does not perform any endian conversions. Furthermore, the length
@@ -99,6 +180,444 @@ public:
         m_position += storage.m_size;
     }
 
+    /// Returns a view of the next bytes in the stream and moves the read
+    /// position past them. The data is not copied, so the view is only
+    /// valid as long as the underlying buffer.
+    /// @param size the number of bytes in the view
+    /// @return storage pointing into the underlying buffer
+    const_storage read_view(uint32_t size)
+    {
+        // Make sure there is enough data to read in the underlying buffer
+        assert(m_size >= m_position + size);
+        const_storage view(&m_buffer[m_position], size);
+        // Advance the current position
+        m_position += size;
+        return view;
+    }
+
+    /// Reads a value at the current position without moving the read
+    /// position
+    /// @return the value
+    template<class ValueType>
+    ValueType peek() const
+    {
+        // Make sure there is enough data to read in the underlying buffer
+        assert(m_size >= m_position + sizeof(ValueType));
+        return big_endian::get<ValueType>(&m_buffer[m_position]);
+    }
+
+    /// Reserves room for a value at the current position and moves the
+    /// position past it. The value is written later using fill() or
+    /// fill_length().
+    /// @return handle to the reserved field
+    template<class ValueType>
+    reserved_field<ValueType> reserve()
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(m_size >= m_position + sizeof(ValueType));
+        reserved_field<ValueType> field(m_position);
+        // Advance the current position
+        m_position += sizeof(ValueType);
+        return field;
+    }
+
+    /// Writes the value of a reserved field without changing the current
+    /// position
+    /// @param field the reserved field
+    /// @param value the value to write
+    template<class ValueType>
+    void fill(const reserved_field<ValueType>& field,
+              typename reserved_field<ValueType>::value_type value)
+    {
+        assert(field.end() <= m_size);
+        big_endian::put<ValueType>(value, &m_buffer[field.position()]);
+    }
+
+    /// Writes the number of bytes between the end of a reserved field
+    /// and the current position into the field, i.e. the length of the
+    /// data written since the field was reserved
+    /// @param field the reserved field
+    template<class ValueType>
+    void fill_length(const reserved_field<ValueType>& field)
+    {
+        assert(field.end() <= m_position);
+        uint32_t length = m_position - field.end();
+
+        assert(length <= std::numeric_limits<ValueType>::max());
+        fill(field, static_cast<ValueType>(length));
+    }
+
+    /// Writes a value to the stream using the variable-length varint
+    /// encoding, see sak::varint. Small values use fewer bytes than
+    /// their fixed-size representation.
+    /// @param value the value to write
+    void write_varint(uint64_t value)
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(m_size >= m_position + varint::size(value));
+        // Write the value at the current position and advance
+        m_position += varint::put(value, &m_buffer[m_position]);
+    }
+
+    /// Reads a varint encoded value from the stream and moves the read
+    /// position.
+    /// @param value reference to the value to be read
+    template<class ValueType>
+    void read_varint(ValueType& value)
+    {
+        uint64_t decoded = 0;
+        uint32_t bytes = varint::get(
+            &m_buffer[m_position], m_size - m_position, decoded);
+
+        // Make sure a complete value was available in the underlying
+        // buffer and that it fits in the ValueType
+        assert(bytes > 0);
+        assert(decoded <= std::numeric_limits<ValueType>::max());
+
+        value = static_cast<ValueType>(decoded);
+        // Advance the current position
+        m_position += bytes;
+    }
+
+    /// Writes a value of the size of ValueType to the stream
+    /// @param value the value to write
+    /// @param ec set to error::insufficient_space if the value does not
+    ///        fit in the buffer
+    template<class ValueType>
+    void write(ValueType value, std::error_code& ec)
+    {
+        if (m_size - m_position < sizeof(ValueType))
+        {
+            fail(error::insufficient_space, ec);
+            return;
+        }
+
+        write(value);
+    }
+
+    /// Writes a value using the specified number of bytes to the stream
+    /// @param value the value to write
+    /// @param ec set to error::insufficient_space if the value does not
+    ///        fit in the buffer
+    template<uint32_t Bytes>
+    void write(uint64_t value, std::error_code& ec)
+    {
+        if (m_size - m_position < Bytes)
+        {
+            fail(error::insufficient_space, ec);
+            return;
+        }
+
+        write<Bytes>(value);
+    }
+
+    /// Writes an array of values to the stream
+    /// @param values pointer to the values to write
+    /// @param count the number of values
+    /// @param ec set to error::insufficient_space if the values do not
+    ///        fit in the buffer
+    template<class ValueType>
+    void write_array(const ValueType* values, uint32_t count,
+                     std::error_code& ec)
+    {
+        if ((m_size - m_position) / sizeof(ValueType) < count)
+        {
+            fail(error::insufficient_space, ec);
+            return;
+        }
+
+        write_array(values, count);
+    }
+
+    /// Writes the contents of a sak::storage container to the stream
+    /// @param storage the storage to write
+    /// @param ec set to error::insufficient_space if the storage does
+    ///        not fit in the buffer
+    void write(const mutable_storage& storage, std::error_code& ec)
+    {
+        write(const_storage(storage), ec);
+    }
+
+    /// @copydoc write(const mutable_storage&, std::error_code&)
+    void write(const const_storage& storage, std::error_code& ec)
+    {
+        if (m_size - m_position < storage.m_size)
+        {
+            fail(error::insufficient_space, ec);
+            return;
+        }
+
+        write(storage);
+    }
+
+    /// Writes a value to the stream using the varint encoding
+    /// @param value the value to write
+    /// @param ec set to error::insufficient_space if the value does not
+    ///        fit in the buffer
+    void write_varint(uint64_t value, std::error_code& ec)
+    {
+        if (m_size - m_position < varint::size(value))
+        {
+            fail(error::insufficient_space, ec);
+            return;
+        }
+
+        write_varint(value);
+    }
+
+    /// Reads from the stream and moves the read position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the value
+    template<class ValueType>
+    void read(ValueType& value, std::error_code& ec)
+    {
+        if (m_size - m_position < sizeof(ValueType))
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read(value);
+    }
+
+    /// Reads a value stored using the specified number of bytes from the
+    /// stream and moves the read position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the value
+    template<uint32_t Bytes, class ValueType>
+    void read(ValueType& value, std::error_code& ec)
+    {
+        if (m_size - m_position < Bytes)
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read<Bytes>(value);
+    }
+
+    /// Reads an array of values from the stream and moves the read
+    /// position
+    /// @param values pointer to where the values are stored
+    /// @param count the number of values to read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the values
+    template<class ValueType>
+    void read_array(ValueType* values, uint32_t count, std::error_code& ec)
+    {
+        if ((m_size - m_position) / sizeof(ValueType) < count)
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read_array(values, count);
+    }
+
+    /// Reads data from the stream to fill a mutable storage
+    /// @param storage the storage to be filled
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain enough data to fill the storage
+    void read(const mutable_storage& storage, std::error_code& ec)
+    {
+        if (m_size - m_position < storage.m_size)
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        read(storage);
+    }
+
+    /// Returns a view of the next bytes in the stream and moves the read
+    /// position past them
+    /// @param size the number of bytes in the view
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain enough data
+    /// @return storage pointing into the underlying buffer, or an empty
+    ///         storage on error
+    const_storage read_view(uint32_t size, std::error_code& ec)
+    {
+        if (m_size - m_position < size)
+        {
+            fail(error::insufficient_data, ec);
+            return const_storage();
+        }
+
+        return read_view(size);
+    }
+
+    /// Reads a varint encoded value from the stream and moves the read
+    /// position
+    /// @param value reference to the value to be read
+    /// @param ec set to error::invalid_varint if the stream does not
+    ///        contain a complete value or the value does not fit in the
+    ///        ValueType
+    template<class ValueType>
+    void read_varint(ValueType& value, std::error_code& ec)
+    {
+        uint64_t decoded = 0;
+        uint32_t bytes = varint::get(
+            &m_buffer[m_position], m_size - m_position, decoded);
+
+        if (bytes == 0 || decoded > std::numeric_limits<ValueType>::max())
+        {
+            fail(error::invalid_varint, ec);
+            return;
+        }
+
+        value = static_cast<ValueType>(decoded);
+        m_position += bytes;
+    }
+
+    /// @return the number of bytes between the current position and the
+    ///         end of the stream
+    uint32_t remaining_size() const;
+
+    /// Writes the contents of a storage preceded by its length. The
+    /// length is written as a LengthType value (e.g. uint16_t) or, if
+    /// LengthType is sak::varint, using the varint encoding.
+    /// @param data the data to write
+    template<class LengthType>
+    void write_bytes(const const_storage& data)
+    {
+        write_length<LengthType>(data.m_size);
+        write(data);
+    }
+
+    /// Writes a string preceded by its length, see write_bytes()
+    /// @param str the string to write
+    template<class LengthType>
+    void write_string(const std::string& str)
+    {
+        write_bytes<LengthType>(storage(str));
+    }
+
+    /// Writes the values of a vector preceded by the number of values,
+    /// see write_bytes(). The values are converted to big-endian format.
+    /// @param values the values to write
+    template<class LengthType, class ValueType, class Allocator>
+    void write_vector(const std::vector<ValueType, Allocator>& values)
+    {
+        uint32_t count = static_cast<uint32_t>(values.size());
+        write_length<LengthType>(count);
+
+        if (count > 0)
+        {
+            write_array(values.data(), count);
+        }
+    }
+
+    /// Reads data preceded by its length written with write_bytes(). The
+    /// data is not copied, the returned storage points into the
+    /// underlying buffer.
+    /// @return storage pointing to the data in the underlying buffer
+    template<class LengthType>
+    const_storage read_bytes()
+    {
+        return read_view(read_length<LengthType>());
+    }
+
+    /// Reads data preceded by its length written with write_bytes()
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the length and the data, or to error::invalid_varint
+    ///        if a varint length is invalid
+    /// @return storage pointing to the data in the underlying buffer, or
+    ///         an empty storage on error
+    template<class LengthType>
+    const_storage read_bytes(std::error_code& ec)
+    {
+        uint32_t length = read_length<LengthType>(ec);
+
+        if (ec)
+        {
+            return const_storage();
+        }
+
+        return read_view(length, ec);
+    }
+
+    /// Reads a string written with write_string()
+    /// @param str the string to assign the data to
+    template<class LengthType>
+    void read_string(std::string& str)
+    {
+        const_storage data = read_bytes<LengthType>();
+        str.assign(reinterpret_cast<const char*>(data.m_data), data.m_size);
+    }
+
+    /// Reads a string written with write_string()
+    /// @param str the string to assign the data to, unchanged on error
+    /// @param ec set as described for read_bytes(std::error_code&)
+    template<class LengthType>
+    void read_string(std::string& str, std::error_code& ec)
+    {
+        const_storage data = read_bytes<LengthType>(ec);
+
+        if (ec)
+        {
+            return;
+        }
+
+        str.assign(reinterpret_cast<const char*>(data.m_data), data.m_size);
+    }
+
+    /// Reads the values of a vector written with write_vector()
+    /// @param values the vector which is resized to hold the values
+    template<class LengthType, class ValueType, class Allocator>
+    void read_vector(std::vector<ValueType, Allocator>& values)
+    {
+        uint32_t count = read_length<LengthType>();
+
+        // Check the length before allocating memory for the values
+        assert(count <= remaining_size() / sizeof(ValueType));
+        values.resize(count);
+
+        if (count > 0)
+        {
+            read_array(values.data(), count);
+        }
+    }
+
+    /// Reads the values of a vector written with write_vector(). The
+    /// length is checked against the remaining data before the vector
+    /// is resized, so an invalid length cannot cause a large allocation.
+    /// @param values the vector which is resized to hold the values,
+    ///        unchanged on error
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the length and the values, or to
+    ///        error::invalid_varint if a varint length is invalid
+    template<class LengthType, class ValueType, class Allocator>
+    void read_vector(std::vector<ValueType, Allocator>& values,
+                     std::error_code& ec)
+    {
+        uint32_t count = read_length<LengthType>(ec);
+
+        if (ec)
+        {
+            return;
+        }
+
+        if (count > remaining_size() / sizeof(ValueType))
+        {
+            fail(error::insufficient_data, ec);
+            return;
+        }
+
+        values.resize(count);
+
+        if (count > 0)
+        {
+            read_array(values.data(), count);
+        }
+    }
+
+    /// Gets a pointer to the underlying buffer
+    /// @return pointer to the start of the buffer
+    uint8_t* data() const;
+
     /// Gets the size of the underlying buffer
     /// @return the size of the buffer
     uint32_t size() const;
@@ -111,6 +630,44 @@ public:
     /// @param new_position the new position
     void seek(uint32_t new_position);
 
+private:
+
+    /// Writes a length prefix, see write_bytes()
+    /// @param length the length to write
+    template<class LengthType>
+    void write_length(uint32_t length)
+    {
+        assert(length <= std::numeric_limits<LengthType>::max());
+        write(static_cast<LengthType>(length));
+    }
+
+    /// Reads a length prefix, see write_bytes()
+    /// @return the length
+    template<class LengthType>
+    uint32_t read_length()
+    {
+        LengthType length = 0;
+        read(length);
+        return static_cast<uint32_t>(length);
+    }
+
+    /// Reads a length prefix, see write_bytes()
+    /// @param ec set on error
+    /// @return the length
+    template<class LengthType>
+    uint32_t read_length(std::error_code& ec)
+    {
+        LengthType length = 0;
+        read(length, ec);
+        return static_cast<uint32_t>(length);
+    }
+
+    /// Marks the stream as failed by setting the error code and moving
+    /// the position to the end of the stream
+    /// @param error the error that occurred
+    /// @param ec the error code to set
+    void fail(error::error_type error, std::error_code& ec);
+
 private:
 
     /// Pointer to the buffer
@@ -122,4 +679,26 @@ private:
     /// The current position
     uint32_t m_position;
 };
+
+template<>
+inline void endian_stream::write_length<varint>(uint32_t length)
+{
+    write_varint(length);
+}
+
+template<>
+inline uint32_t endian_stream::read_length<varint>()
+{
+    uint32_t length = 0;
+    read_varint(length);
+    return length;
+}
+
+template<>
+inline uint32_t endian_stream::read_length<varint>(std::error_code& ec)
+{
+    uint32_t length = 0;
+    read_varint(length, ec);
+    return length;
+}
 }
@@ -20,6 +20,18 @@ std::string sak_category_impl::message(int ev) const
     {
     case error_type::failed_open_file:
         return "Failed to open file";
+    case error_type::insufficient_data:
+        return "Not enough data in the stream";
+    case error_type::insufficient_space:
+        return "Not enough space in the stream";
+    case error_type::invalid_varint:
+        return "Invalid varint in the stream";
+    case error_type::failed_write_file:
+        return "Failed to write file";
+    case error_type::failed_read_file:
+        return "Failed to read file";
+    case error_type::file_too_large:
+        return "File too large";
     default:
         // LCOV_EXCL_START This line will not be executed.
         return "Unknown error";
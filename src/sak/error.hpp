@@ -16,7 +16,13 @@ namespace error
 /// Enumeration of different error codes
 enum error_type
 {
-    failed_open_file = 1
+    failed_open_file = 1,
+    insufficient_data,
+    insufficient_space,
+    invalid_varint,
+    failed_write_file,
+    failed_read_file,
+    file_too_large
 };
 
 /// sak error category with C++11 error handling
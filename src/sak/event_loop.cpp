@@ -0,0 +1,392 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__linux__)
+
+#include "event_loop.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "error.hpp"
+
+namespace sak
+{
+namespace
+{
+/// The identifier of the eventfd in the epoll events
+const uint64_t wakeup_id = 0;
+}
+
+event_loop::event_loop(uint32_t batch_size) :
+    m_batch_size(batch_size),
+    m_epoll_fd(::epoll_create1(EPOLL_CLOEXEC)),
+    m_wakeup_fd(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+    m_next_id(wakeup_id + 1),
+    m_stop(false)
+{
+    assert(m_batch_size > 0);
+
+    if (m_epoll_fd < 0 || m_wakeup_fd < 0)
+    {
+        std::error_code ec(errno, std::system_category());
+
+        if (m_epoll_fd >= 0)
+            ::close(m_epoll_fd);
+        if (m_wakeup_fd >= 0)
+            ::close(m_wakeup_fd);
+
+        error::throw_error(ec);
+    }
+
+    // The eventfd is level-triggered, so it wakes up all threads until
+    // it is drained
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = wakeup_id;
+
+    int result = ::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_wakeup_fd, &event);
+    assert(result == 0);
+    (void) result;
+}
+
+event_loop::~event_loop()
+{
+    ::close(m_wakeup_fd);
+    ::close(m_epoll_fd);
+}
+
+void event_loop::add(fd_input_stream& stream)
+{
+    assert(!stream.stopped());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(m_registrations.count(&stream) == 0);
+
+    std::unique_ptr<registration> entry(new registration());
+    entry->m_id = m_next_id++;
+    entry->m_stream = &stream;
+    entry->m_queued = false;
+    entry->m_running = false;
+    entry->m_again = false;
+    entry->m_removed = false;
+    entry->m_hangup = false;
+
+    // The identifier is used instead of a pointer, since another thread
+    // may receive an event for a stream which has just been removed
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = entry->m_id;
+
+    int result = ::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD,
+                             stream.native_handle(), &event);
+    assert(result == 0);
+    (void) result;
+
+    m_ids[entry->m_id] = entry.get();
+    m_registrations[&stream] = std::move(entry);
+}
+
+void event_loop::remove(fd_input_stream& stream)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto it = m_registrations.find(&stream);
+    assert(it != m_registrations.end());
+
+    registration* entry = it->second.get();
+
+    if (entry->m_running)
+    {
+        // Removed from its own callback, the stream is erased when the
+        // turn is over
+        if (entry->m_running_thread == std::this_thread::get_id())
+        {
+            ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, stream.native_handle(), 0);
+            entry->m_removed = true;
+            return;
+        }
+
+        m_idle.wait(lock, [this, &stream]()
+        {
+            auto it = m_registrations.find(&stream);
+            return it == m_registrations.end() || !it->second->m_running;
+        });
+
+        // The stream may have stopped meanwhile
+        it = m_registrations.find(&stream);
+        if (it == m_registrations.end())
+            return;
+
+        entry = it->second.get();
+    }
+
+    erase(entry);
+}
+
+uint32_t event_loop::streams() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (uint32_t)m_registrations.size();
+}
+
+void event_loop::post(const std::function<void()>& handler)
+{
+    assert(handler);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_posted.push_back(handler);
+    }
+
+    wake_up();
+}
+
+void event_loop::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    wake_up();
+}
+
+uint32_t event_loop::run_once(int timeout_ms)
+{
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ready = !m_ready.empty() || !m_posted.empty();
+    }
+
+    // Do not wait if some streams are still ready
+    epoll_event events[64];
+    int count = ::epoll_wait(m_epoll_fd, events, 64,
+                             ready ? 0 : timeout_ms);
+
+    std::vector<std::function<void()>> handlers;
+    uint32_t turns;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.u64 == wakeup_id)
+            {
+                // Keep the eventfd readable when the loop is done, so
+                // that all threads return
+                if (!finished())
+                {
+                    uint64_t value;
+                    ssize_t result = ::read(m_wakeup_fd, &value,
+                                            sizeof(value));
+                    (void) result;
+                }
+                continue;
+            }
+
+            auto it = m_ids.find(events[i].data.u64);
+            if (it == m_ids.end())
+                continue;
+
+            if (events[i].events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR))
+            {
+                it->second->m_hangup = true;
+            }
+
+            enqueue(it->second);
+        }
+
+        handlers.swap(m_posted);
+
+        // Streams queued during the turns are processed in the next
+        // iteration
+        turns = (uint32_t)m_ready.size();
+    }
+
+    for (const auto& handler : handlers)
+    {
+        handler();
+    }
+
+    uint32_t processed = (uint32_t)handlers.size();
+
+    for (uint32_t i = 0; i < turns; ++i)
+    {
+        registration* entry;
+        bool hangup;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if (m_ready.empty())
+                break;
+
+            entry = m_ready.front();
+            m_ready.pop_front();
+
+            entry->m_queued = false;
+            entry->m_running = true;
+            entry->m_running_thread = std::this_thread::get_id();
+            hangup = entry->m_hangup;
+        }
+
+        process(entry, hangup);
+        ++processed;
+    }
+
+    return processed;
+}
+
+void event_loop::run(uint32_t threads)
+{
+    assert(threads > 0);
+
+    auto loop = [this]()
+    {
+        while (true)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (finished())
+                    return;
+            }
+
+            run_once(-1);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(loop);
+    }
+
+    loop();
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = false;
+}
+
+void event_loop::process(registration* entry, bool hangup)
+{
+    // Only this thread uses the stream until the turn is over
+    fd_input_stream* stream = entry->m_stream;
+
+    uint32_t available = stream->bytes_available();
+    bool progress = false;
+
+    for (uint32_t i = 0; i < m_batch_size; ++i)
+    {
+        stream->process_events(hangup);
+
+        // The stream may have been destroyed after removing itself
+        if (entry->m_removed)
+            break;
+
+        if (stream->stopped())
+            break;
+
+        // Stop if the callback did not read anything
+        uint32_t remaining = stream->bytes_available();
+        if (remaining >= available)
+            break;
+
+        available = remaining;
+        progress = true;
+
+        if (available == 0)
+            break;
+    }
+
+    // No events will follow a hangup, so a stream whose callback leaves
+    // the data unread would never be processed again
+    if (!entry->m_removed && !stream->stopped() && !progress &&
+        stream->hangup())
+    {
+        stream->stop();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    entry->m_running = false;
+
+    if (entry->m_removed || stream->stopped())
+    {
+        erase(entry);
+    }
+    else if ((progress && (available > 0 || stream->hangup())) ||
+             entry->m_again)
+    {
+        // Edge-triggered epoll will not report the stream again. A
+        // stream whose callback leaves the data unread waits for new
+        // events instead of spinning.
+        enqueue(entry);
+    }
+
+    m_idle.notify_all();
+}
+
+void event_loop::enqueue(registration* entry)
+{
+    if (entry->m_running)
+    {
+        entry->m_again = true;
+        return;
+    }
+
+    entry->m_again = false;
+
+    if (entry->m_queued)
+        return;
+
+    entry->m_queued = true;
+    m_ready.push_back(entry);
+}
+
+void event_loop::erase(registration* entry)
+{
+    fd_input_stream* stream = entry->m_stream;
+
+    if (!entry->m_removed)
+    {
+        ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, stream->native_handle(), 0);
+    }
+
+    m_ready.erase(std::remove(m_ready.begin(), m_ready.end(), entry),
+                  m_ready.end());
+    m_ids.erase(entry->m_id);
+    m_registrations.erase(stream);
+
+    if (finished())
+    {
+        wake_up();
+    }
+}
+
+bool event_loop::finished() const
+{
+    return m_stop || (m_registrations.empty() && m_posted.empty());
+}
+
+void event_loop::wake_up()
+{
+    uint64_t value = 1;
+    ssize_t result = ::write(m_wakeup_fd, &value, sizeof(value));
+    (void) result;
+}
+}
+
+#endif
@@ -0,0 +1,183 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__linux__)
+#error "sak::event_loop requires Linux"
+#endif
+
+#include <cstdint>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "fd_input_stream.hpp"
+
+namespace sak
+{
+/// Event loop (reactor) driving a number of sak::fd_input_stream objects
+/// using edge-triggered epoll.
+///
+/// The loop can be run from one or several threads. A stream is only
+/// processed by one thread at a time, so the callbacks of a stream are
+/// never invoked concurrently. Every ready stream gets a turn before a
+/// stream is processed again, and during a turn the ready read callback
+/// of the stream is invoked at most batch_size times, or until a callback
+/// leaves the data unread. A stream which still has data available after
+/// its turn is queued again if its callback read some data, otherwise it
+/// waits for new data to arrive. If the writing end of such a stream has
+/// been closed no more data will arrive, so the stream is stopped and
+/// the data left unread is discarded. Stopped streams are removed from
+/// the loop automatically.
+///
+/// Functions can be posted to the loop from any thread. They are invoked
+/// by one of the threads running the loop, which are woken up using an
+/// eventfd.
+///
+/// The streams must be removed from the loop before they are destroyed.
+///
+/// Only available on Linux.
+class event_loop
+{
+public:
+
+    /// Constructor
+    /// @param batch_size the maximum number of times the ready read
+    ///        callback of a stream is invoked per turn
+    /// @throws std::system_error Thrown if the epoll instance cannot be
+    ///         created.
+    event_loop(uint32_t batch_size = 1);
+
+    /// Destructor
+    ~event_loop();
+
+    /// The event loop is not copyable
+    event_loop(const event_loop&) = delete;
+
+    /// The event loop is not copyable
+    event_loop& operator=(const event_loop&) = delete;
+
+    /// Adds a stream to the loop
+    /// @param stream the stream, must not be stopped
+    void add(fd_input_stream& stream);
+
+    /// Removes a stream from the loop. If the stream is being processed
+    /// by another thread, the function waits until it is done.
+    /// @param stream the stream
+    void remove(fd_input_stream& stream);
+
+    /// @return the number of streams in the loop
+    uint32_t streams() const;
+
+    /// Posts a function which is invoked by a thread running the loop.
+    /// This function is thread-safe.
+    /// @param handler the function to invoke
+    void post(const std::function<void()>& handler);
+
+    /// Makes the threads running the loop return. This function is
+    /// thread-safe.
+    void stop();
+
+    /// Waits for events, invokes the posted functions and gives every
+    /// stream which is ready a turn
+    /// @param timeout_ms the maximum time to wait in milliseconds, -1
+    ///        waits until an event occurs
+    /// @return the number of streams processed and functions invoked
+    uint32_t run_once(int timeout_ms = -1);
+
+    /// Processes events until stop() is called or until all streams
+    /// have been stopped or removed and no posted functions remain
+    /// @param threads the number of threads running the loop, including
+    ///        the calling thread
+    void run(uint32_t threads = 1);
+
+private:
+
+    /// The state of a stream in the loop
+    struct registration
+    {
+        /// The identifier used for the epoll events
+        uint64_t m_id;
+
+        /// The stream
+        fd_input_stream* m_stream;
+
+        /// True if the stream is in the ready queue
+        bool m_queued;
+
+        /// True if the stream is being processed
+        bool m_running;
+
+        /// The thread processing the stream
+        std::thread::id m_running_thread;
+
+        /// True if the stream became ready again while being processed
+        bool m_again;
+
+        /// True if the stream was removed while being processed
+        bool m_removed;
+
+        /// True if the writing end of the stream has been closed
+        bool m_hangup;
+    };
+
+    /// Processes one turn of a stream
+    void process(registration* entry, bool hangup);
+
+    /// Queues a stream for processing, requires the lock
+    void enqueue(registration* entry);
+
+    /// Removes a stream from the loop, requires the lock
+    void erase(registration* entry);
+
+    /// @return true if the loop has nothing more to do, requires the lock
+    bool finished() const;
+
+    /// Wakes up the threads waiting for events
+    void wake_up();
+
+private:
+
+    /// The maximum number of callbacks per turn
+    const uint32_t m_batch_size;
+
+    /// The epoll file descriptor
+    int m_epoll_fd;
+
+    /// The eventfd used to wake up the threads
+    int m_wakeup_fd;
+
+    /// The identifier of the next stream added
+    uint64_t m_next_id;
+
+    /// True when stop() has been called
+    bool m_stop;
+
+    /// The streams in the loop
+    std::unordered_map<fd_input_stream*, std::unique_ptr<registration>>
+        m_registrations;
+
+    /// The streams by identifier
+    std::unordered_map<uint64_t, registration*> m_ids;
+
+    /// The streams which are ready to be processed
+    std::deque<registration*> m_ready;
+
+    /// The posted functions
+    std::vector<std::function<void()>> m_posted;
+
+    /// Protects the state of the loop
+    mutable std::mutex m_mutex;
+
+    /// Signals that a stream is no longer being processed
+    std::condition_variable m_idle;
+};
+}
@@ -0,0 +1,186 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__linux__)
+
+#include "fd_input_stream.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace sak
+{
+fd_input_stream::fd_input_stream(int fd) :
+    m_fd(fd),
+    m_hangup(false),
+    m_failed(false),
+    m_stopped(false)
+{
+    assert(m_fd >= 0);
+
+    int flags = ::fcntl(m_fd, F_GETFL, 0);
+    assert(flags >= 0);
+
+    ::fcntl(m_fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+fd_input_stream::~fd_input_stream()
+{
+    ::close(m_fd);
+}
+
+int fd_input_stream::native_handle() const
+{
+    return m_fd;
+}
+
+void fd_input_stream::process_events(bool hangup)
+{
+    if (m_stopped)
+        return;
+
+    m_hangup = m_hangup || hangup;
+
+    // Deliver any data before reporting the end of the stream. The
+    // stream may be destroyed by the callback, so it is not used after.
+    if (!m_failed && bytes_available() > 0)
+    {
+        if (m_ready_read_callback)
+        {
+            m_ready_read_callback();
+        }
+        return;
+    }
+
+    // The end of the stream found while reading is only reported on the
+    // next call, so the callbacks are never nested
+    if (m_hangup || m_failed)
+    {
+        stop();
+    }
+}
+
+void fd_input_stream::read(uint8_t* buffer, uint32_t bytes)
+{
+    assert(buffer != 0);
+    assert(bytes <= bytes_available());
+
+    uint32_t buffered = m_peek_buffer.read(buffer, bytes);
+    uint32_t received = read_fd(buffer + buffered, bytes - buffered);
+
+    // The data counted by FIONREAD can only be missing after an error,
+    // which read_fd() has reported
+    assert(buffered + received == bytes || m_failed);
+    (void) received;
+}
+
+uint32_t fd_input_stream::bytes_available()
+{
+    return m_peek_buffer.size() + fd_bytes_available();
+}
+
+bool fd_input_stream::hangup() const
+{
+    return m_hangup || m_failed;
+}
+
+bool fd_input_stream::stopped()
+{
+    return m_stopped;
+}
+
+const_storage fd_input_stream::peek(uint32_t max_bytes)
+{
+    uint32_t buffered = m_peek_buffer.size();
+
+    if (buffered < max_bytes)
+    {
+        uint32_t bytes = std::min(max_bytes - buffered, fd_bytes_available());
+
+        if (bytes > 0)
+        {
+            uint8_t* data = m_peek_buffer.prepare(bytes);
+            m_peek_buffer.commit(read_fd(data, bytes));
+        }
+    }
+
+    return m_peek_buffer.data(max_bytes);
+}
+
+void fd_input_stream::consume(uint32_t bytes)
+{
+    m_peek_buffer.consume(bytes);
+}
+
+uint32_t fd_input_stream::read_fd(uint8_t* buffer, uint32_t bytes)
+{
+    uint32_t total = 0;
+
+    while (total < bytes && !m_stopped && !m_failed)
+    {
+        ssize_t result = ::read(m_fd, buffer + total, bytes - total);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            // No data has arrived yet
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+
+            if (m_error_callback)
+            {
+                m_error_callback(std::system_category().message(errno));
+            }
+
+            // The stream is stopped by process_events()
+            m_failed = true;
+            break;
+        }
+
+        if (result == 0)
+        {
+            m_hangup = true;
+            break;
+        }
+
+        total += (uint32_t)result;
+    }
+
+    return total;
+}
+
+uint32_t fd_input_stream::fd_bytes_available() const
+{
+    int bytes = 0;
+
+    if (::ioctl(m_fd, FIONREAD, &bytes) != 0 || bytes < 0)
+        return 0;
+
+    return (uint32_t)bytes;
+}
+
+void fd_input_stream::stop()
+{
+    if (m_stopped)
+        return;
+
+    m_stopped = true;
+
+    if (m_stopped_callback)
+    {
+        m_stopped_callback();
+    }
+}
+}
+
+#endif
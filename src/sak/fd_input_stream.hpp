@@ -0,0 +1,124 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__linux__)
+#error "sak::fd_input_stream requires Linux"
+#endif
+
+#include <cstdint>
+
+#include "input_stream.hpp"
+#include "peek_buffer.hpp"
+
+namespace sak
+{
+/// A live input stream reading from a file descriptor such as a pipe,
+/// a FIFO or a Unix socket. The file descriptor is switched to
+/// non-blocking mode and closed when the stream is destroyed.
+///
+/// The stream is driven by a sak::event_loop which calls
+/// process_events() when the file descriptor becomes readable. The
+/// ready read callback is then invoked while data is available, and
+/// the stopped callback once the writing end has been closed and all
+/// data has been read.
+///
+/// Only available on Linux.
+class fd_input_stream : public input_stream
+{
+public:
+
+    /// Constructor
+    /// @param fd the file descriptor to read from, the stream takes
+    ///        ownership of it
+    fd_input_stream(int fd);
+
+    /// Destructor, closes the file descriptor
+    ~fd_input_stream();
+
+    /// The stream is not copyable
+    fd_input_stream(const fd_input_stream&) = delete;
+
+    /// The stream is not copyable
+    fd_input_stream& operator=(const fd_input_stream&) = delete;
+
+    /// @return the file descriptor
+    int native_handle() const;
+
+    /// Handles the readiness of the file descriptor. Invokes the ready
+    /// read callback if data is available, otherwise the stream is
+    /// stopped if the writing end has been closed or reading failed.
+    /// The stream is not used after the callback, so the callback may
+    /// destroy it.
+    /// @param hangup true if the writing end has been closed
+    void process_events(bool hangup);
+
+    /// @return true if the writing end has been closed or reading has
+    ///         failed, the stream is stopped by the next call to
+    ///         process_events() once the data has been read
+    bool hangup() const;
+
+    /// Stops the stream and invokes the stopped callback, discarding any
+    /// data left unread. Used by sak::event_loop for a stream whose
+    /// writing end has been closed but whose callback no longer reads.
+    /// Must not be called from the callbacks of the stream.
+    void stop();
+
+public: // From input_stream
+
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
+    /// Only the data which has arrived can be read, so bytes must not
+    /// exceed bytes_available(). Errors are reported through the error
+    /// callback and the stream is stopped by the next call to
+    /// process_events().
+    void read(uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc input_stream::bytes_available()
+    /// The number of bytes is queried using FIONREAD.
+    uint32_t bytes_available();
+
+    /// @copydoc input_stream::stopped()
+    bool stopped();
+
+    /// @copydoc input_stream::peek()
+    /// The data is read from the file descriptor into a sak::peek_buffer.
+    const_storage peek(uint32_t max_bytes);
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes);
+
+private:
+
+    /// Reads from the file descriptor
+    /// @param buffer the destination
+    /// @param bytes the number of bytes to read
+    /// @return the number of bytes read, less than bytes if no more data
+    ///         has arrived or the stream stopped
+    uint32_t read_fd(uint8_t* buffer, uint32_t bytes);
+
+    /// @return the number of bytes readable from the file descriptor
+    uint32_t fd_bytes_available() const;
+
+private:
+
+    /// The file descriptor
+    int m_fd;
+
+    /// True if the writing end has been closed
+    bool m_hangup;
+
+    /// True if reading from the file descriptor failed
+    bool m_failed;
+
+    /// True when the stream is stopped
+    bool m_stopped;
+
+    /// The data read ahead by peek()
+    peek_buffer m_peek_buffer;
+};
+}
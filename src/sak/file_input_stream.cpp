@@ -7,6 +7,7 @@
 
 #include <cassert>
 #include <fstream>
+#include <limits>
 
 #include "error.hpp"
 
@@ -59,6 +60,14 @@ void file_input_stream::open(const std::string& filename,
     auto pos = m_file.tellg();
     assert(pos >= 0);
 
+    // The size of the stream is limited to 32 bits
+    if ((uint64_t)pos > std::numeric_limits<uint32_t>::max())
+    {
+        m_file.close();
+        ec = error::file_too_large;
+        return;
+    }
+
     m_filesize = (uint32_t)pos;
 
     m_file.seekg(0, std::ios::beg);
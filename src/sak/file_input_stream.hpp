@@ -17,6 +17,14 @@ namespace sak
 {
 /// A file input stream for reading local
 /// files. Mainly used for testing purposes.
+///
+/// The stream reads through std::ifstream, so it uses the default
+/// read() of a storage sequence which reads the buffers one at a time.
+/// sak::pread_file_input_stream fills a sequence with a single system
+/// call on POSIX platforms. Likewise peek() copies the data using the
+/// read and seek back implementation of sak::finite_input_stream, while
+/// sak::pread_file_input_stream returns a view into its internal
+/// buffer.
 class file_input_stream : public finite_input_stream
 {
 public:
@@ -36,7 +44,8 @@ public:
 
     /// Opens the file
     /// @param filename the file name
-    /// @param ec on error set to indicate the type of error
+    /// @param ec on error set to indicate the type of error, files of
+    ///        4 GiB or more are rejected with error::file_too_large
     void open(const std::string& filename, std::error_code& ec);
 
     /// Closes the file
@@ -55,7 +64,9 @@ public: // From finite_input_stream
 
 public: // From input_stream
 
-    /// @copydoc input_stream::read()
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
     void read(uint8_t* buffer, uint32_t bytes);
 
     /// @copydoc input_stream::bytes_available()
@@ -0,0 +1,295 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "file_output_stream.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace sak
+{
+namespace
+{
+/// The largest number of buffers passed to a single writev() call
+const uint32_t max_batch = IOV_MAX < 64 ? IOV_MAX : 64;
+
+/// Writes all the buffers to the file, retrying after partial writes
+/// and interrupts
+/// @param written incremented by the number of bytes written
+/// @return false if the write failed
+bool write_all(int fd, iovec* vec, uint32_t count, uint64_t& written)
+{
+    while (count > 0)
+    {
+        int batch = (int) std::min<uint32_t>(count, IOV_MAX);
+        ssize_t result = ::writev(fd, vec, batch);
+
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            return false;
+        }
+
+        written += (uint64_t) result;
+
+        // Skip the buffers which were completely written
+        size_t remaining = (size_t) result;
+        while (count > 0 && remaining >= vec->iov_len)
+        {
+            remaining -= vec->iov_len;
+            ++vec;
+            --count;
+        }
+
+        if (remaining > 0)
+        {
+            vec->iov_base = static_cast<uint8_t*>(vec->iov_base) + remaining;
+            vec->iov_len -= remaining;
+        }
+    }
+
+    return true;
+}
+}
+
+file_output_stream::file_output_stream(uint32_t buffer_size) :
+    m_fd(-1),
+    m_buffer(buffer_size),
+    m_buffered(0),
+    m_bytes_written(0)
+{ }
+
+file_output_stream::file_output_stream(const std::string& filename,
+                                       uint32_t buffer_size) :
+    m_fd(-1),
+    m_buffer(buffer_size),
+    m_buffered(0),
+    m_bytes_written(0)
+{
+    open(filename);
+}
+
+file_output_stream::~file_output_stream()
+{
+    if (is_open())
+    {
+        std::error_code ec;
+        close(ec);
+    }
+}
+
+void file_output_stream::open(const std::string& filename)
+{
+    assert(!is_open());
+
+    std::error_code ec;
+    open(filename, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void file_output_stream::open(const std::string& filename,
+                              std::error_code& ec)
+{
+    assert(!is_open());
+
+    m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (m_fd < 0)
+    {
+        ec = error::failed_open_file;
+        return;
+    }
+
+    m_buffered = 0;
+    m_bytes_written = 0;
+}
+
+void file_output_stream::close()
+{
+    std::error_code ec;
+    close(ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void file_output_stream::close(std::error_code& ec)
+{
+    assert(is_open());
+
+    flush(ec);
+
+    if (::close(m_fd) != 0 && !ec)
+    {
+        ec = error::failed_write_file;
+    }
+
+    m_fd = -1;
+}
+
+bool file_output_stream::is_open() const
+{
+    return m_fd >= 0;
+}
+
+void file_output_stream::write(const uint8_t* buffer, uint32_t bytes,
+                               std::error_code& ec)
+{
+    assert(buffer != 0);
+    assert(bytes > 0);
+
+    const_storage storage(buffer, bytes);
+    write(&storage, &storage + 1, ec);
+}
+
+void file_output_stream::write(const const_storage* first,
+                               const const_storage* last,
+                               std::error_code& ec)
+{
+    assert(is_open());
+    assert(first <= last);
+
+    uint32_t bytes = storage_size(first, last);
+
+    // Coalesce the data if it fits in the buffer
+    if (bytes <= m_buffer.size() - m_buffered)
+    {
+        for (; first != last; ++first)
+        {
+            std::copy_n(first->m_data, first->m_size,
+                        m_buffer.data() + m_buffered);
+            m_buffered += first->m_size;
+        }
+        return;
+    }
+
+    // Otherwise write the buffered data and the sequence together, in
+    // batches of at most max_batch buffers
+    iovec vec[max_batch];
+    uint32_t count = 0;
+
+    if (m_buffered > 0)
+    {
+        vec[count].iov_base = m_buffer.data();
+        vec[count].iov_len = m_buffered;
+        ++count;
+    }
+
+    m_buffered = 0;
+
+    for (; first != last; ++first)
+    {
+        if (first->m_size == 0)
+            continue;
+
+        if (count == max_batch)
+        {
+            if (!write_all(m_fd, vec, count, m_bytes_written))
+            {
+                ec = error::failed_write_file;
+                return;
+            }
+
+            count = 0;
+        }
+
+        vec[count].iov_base = const_cast<uint8_t*>(first->m_data);
+        vec[count].iov_len = first->m_size;
+        ++count;
+    }
+
+    if (!write_all(m_fd, vec, count, m_bytes_written))
+    {
+        ec = error::failed_write_file;
+    }
+}
+
+void file_output_stream::flush(std::error_code& ec)
+{
+    assert(is_open());
+
+    if (m_buffered == 0)
+        return;
+
+    iovec buffered = { m_buffer.data(), m_buffered };
+    m_buffered = 0;
+
+    if (!write_all(m_fd, &buffered, 1, m_bytes_written))
+    {
+        ec = error::failed_write_file;
+    }
+}
+
+uint64_t file_output_stream::bytes_written() const
+{
+    return m_bytes_written + m_buffered;
+}
+
+uint32_t file_output_stream::buffered_bytes() const
+{
+    return m_buffered;
+}
+
+void file_output_stream::write(const uint8_t* buffer, uint32_t bytes)
+{
+    std::error_code ec;
+    write(buffer, bytes, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void file_output_stream::write(const const_storage* first,
+                               const const_storage* last)
+{
+    std::error_code ec;
+    write(first, last, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void file_output_stream::flush()
+{
+    std::error_code ec;
+    flush(ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+}
+
+#endif
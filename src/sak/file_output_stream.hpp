@@ -0,0 +1,137 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "sak::file_output_stream requires a POSIX platform"
+#endif
+
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "error.hpp"
+#include "output_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// A file output stream for writing local files using the POSIX write()
+/// and writev() functions. The stream is only available on POSIX
+/// platforms.
+///
+/// Small writes are coalesced in a user-space buffer which is written to
+/// the file when it is full or when flush() is called. Writes which do
+/// not fit in the buffer are written together with the buffered data
+/// using a single writev() call, so e.g. a header and its payload chunks
+/// reach the file in one system call without being copied.
+class file_output_stream : public output_stream
+{
+public:
+
+    /// Constructor
+    /// @param buffer_size the size of the coalescing buffer in bytes
+    file_output_stream(uint32_t buffer_size = 65536);
+
+    /// Constructor that opens the file immediately
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the filename
+    /// @param buffer_size the size of the coalescing buffer in bytes
+    file_output_stream(const std::string& filename,
+                       uint32_t buffer_size = 65536);
+
+    /// Destructor, writes any buffered data and closes the file. Errors
+    /// are ignored, call close() to detect them.
+    ~file_output_stream();
+
+    /// The stream is not copyable
+    file_output_stream(const file_output_stream&) = delete;
+
+    /// The stream is not copyable
+    file_output_stream& operator=(const file_output_stream&) = delete;
+
+    /// Opens the file, an existing file is truncated
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the file name
+    void open(const std::string& filename);
+
+    /// Opens the file, an existing file is truncated
+    /// @param filename the file name
+    /// @param ec on error set to indicate the type of error
+    void open(const std::string& filename, std::error_code& ec);
+
+    /// Writes any buffered data and closes the file
+    /// @throws std::system_error Thrown on failure.
+    void close();
+
+    /// Writes any buffered data and closes the file
+    /// @param ec on error set to indicate the type of error
+    void close(std::error_code& ec);
+
+    /// @return true if a file is open
+    bool is_open() const;
+
+    /// Writes data to the file
+    /// @param buffer the data to write
+    /// @param bytes the number of bytes to write
+    /// @param ec on error set to error::failed_write_file, the data
+    ///        buffered by the stream is then discarded
+    void write(const uint8_t* buffer, uint32_t bytes, std::error_code& ec);
+
+    /// Writes a sequence of storage buffers to the file
+    /// @param first pointer to the first storage buffer
+    /// @param last pointer to the end of the storage sequence
+    /// @param ec on error set to error::failed_write_file, the data
+    ///        buffered by the stream is then discarded
+    void write(const const_storage* first, const const_storage* last,
+               std::error_code& ec);
+
+    /// Writes the buffered data to the file
+    /// @param ec on error set to error::failed_write_file, the data
+    ///        buffered by the stream is then discarded
+    void flush(std::error_code& ec);
+
+    /// @return the number of bytes written to the file plus the bytes
+    ///         which are still buffered. After an error only the bytes
+    ///         which reached the file are counted.
+    uint64_t bytes_written() const;
+
+    /// @return the number of bytes waiting in the coalescing buffer
+    uint32_t buffered_bytes() const;
+
+public: // From output_stream
+
+    using output_stream::write;
+
+    /// @copydoc output_stream::write(const uint8_t*, uint32_t)
+    /// @throws std::system_error Thrown on failure.
+    void write(const uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc output_stream::write(const const_storage*,
+    ///                               const const_storage*)
+    /// @throws std::system_error Thrown on failure.
+    void write(const const_storage* first, const const_storage* last);
+
+    /// @copydoc output_stream::flush()
+    /// @throws std::system_error Thrown on failure.
+    void flush();
+
+private:
+
+    /// The file descriptor, -1 if no file is open
+    int m_fd;
+
+    /// The coalescing buffer
+    std::vector<uint8_t> m_buffer;
+
+    /// The number of bytes in the coalescing buffer
+    uint32_t m_buffered;
+
+    /// The number of bytes written to the file
+    uint64_t m_bytes_written;
+};
+}
@@ -6,7 +6,10 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "input_stream.hpp"
 
@@ -40,5 +43,35 @@ public: /// From input_stream
     {
         return true;
     }
+
+    /// @copydoc input_stream::peek()
+    /// The data is read and the read position is restored, so peek() and
+    /// read() can be mixed freely.
+    const_storage peek(uint32_t max_bytes)
+    {
+        uint32_t bytes = std::min(max_bytes, bytes_available());
+        m_peek_buffer.resize(bytes);
+
+        if (bytes > 0)
+        {
+            uint32_t position = read_position();
+            read(m_peek_buffer.data(), bytes);
+            seek(position);
+        }
+
+        return const_storage(m_peek_buffer.data(), bytes);
+    }
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes)
+    {
+        assert(bytes <= bytes_available());
+        seek(read_position() + bytes);
+    }
+
+protected:
+
+    /// Buffer used by the copying implementations of peek()
+    std::vector<uint8_t> m_peek_buffer;
 };
 }
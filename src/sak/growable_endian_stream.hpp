@@ -0,0 +1,280 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+#include "buffer.hpp"
+#include "duplex_buffer.hpp"
+#include "storage.hpp"
+#include "convert_endian.hpp"
+#include "reserved_field.hpp"
+
+namespace sak
+{
+// Do not expose implementation details to users of this header file
+namespace detail
+{
+/// Re-sizes a sak::buffer
+inline void resize_stream_buffer(buffer& b, uint32_t size)
+{
+    b.resize(size);
+}
+
+/// Re-sizes the back of a sak::duplex_buffer
+inline void resize_stream_buffer(duplex_buffer& b, uint32_t size)
+{
+    b.resize_back(size);
+}
+}
+
+/// The growable_endian_stream provides the write interface of the
+/// sak::endian_stream on top of a sak::buffer or sak::duplex_buffer
+/// which is grown as needed. This makes it possible to encode messages
+/// of variable size in a single pass.
+///
+/// The stream appends to the existing content of the buffer. While the
+/// stream is writing, the buffer is grown in steps (at least doubling
+/// the reserved size) and may therefore be larger than the data written.
+/// Call trim() or destroy the stream to make the buffer size match the
+/// number of bytes written.
+///
+/// Example:
+///
+///     sak::buffer message;
+///     {
+///         sak::growable_endian_stream<sak::buffer> stream(message);
+///         stream.write<uint16_t>(42);
+///         stream.write_varint(length);
+///     }
+///     // message.size() is now the encoded size
+///
+template<class Buffer>
+class growable_endian_stream
+{
+public:
+
+    /// Creates a stream appending to the specified buffer
+    /// @param buffer the buffer to write to, must outlive the stream
+    growable_endian_stream(Buffer& buffer) :
+        m_buffer(buffer),
+        m_data(0),
+        m_capacity(buffer.size()),
+        m_size(buffer.size()),
+        m_position(buffer.size())
+    {
+        if (m_capacity > 0)
+        {
+            m_data = m_buffer.data();
+        }
+    }
+
+    /// The stream is not copyable
+    growable_endian_stream(const growable_endian_stream&) = delete;
+
+    /// The stream is not copyable
+    growable_endian_stream& operator=(const growable_endian_stream&) = delete;
+
+    /// Destructor, trims the buffer to the size of the written data
+    ~growable_endian_stream()
+    {
+        trim();
+    }
+
+    /// Writes a value of the size of ValueType to the stream
+    /// @param value the value to write
+    template<class ValueType>
+    void write(ValueType value)
+    {
+        reserve_capacity(sizeof(ValueType));
+        big_endian::put<ValueType>(value, m_data + m_position);
+        advance(sizeof(ValueType));
+    }
+
+    /// Writes a value using the specified number of bytes to the stream
+    /// @param value the value to write
+    template<uint32_t Bytes>
+    void write(uint64_t value)
+    {
+        reserve_capacity(Bytes);
+        big_endian::put<Bytes>(value, m_data + m_position);
+        advance(Bytes);
+    }
+
+    /// Writes a value to the stream using the varint encoding
+    /// @param value the value to write
+    void write_varint(uint64_t value)
+    {
+        reserve_capacity(varint::max_size<uint64_t>());
+        advance(varint::put(value, m_data + m_position));
+    }
+
+    /// Writes an array of values to the stream. Note that the number of
+    /// values is not written to the stream.
+    /// @param values pointer to the values to write
+    /// @param count the number of values
+    template<class ValueType>
+    void write_array(const ValueType* values, uint32_t count)
+    {
+        reserve_capacity(count * sizeof(ValueType));
+        big_endian::put_array<ValueType>(values, count, m_data + m_position);
+        advance(count * sizeof(ValueType));
+    }
+
+    /// Writes the contents of a sak::storage container to the stream.
+    /// Note that this function does not perform any endian conversions
+    /// and that the length of the container is not written to the stream.
+    /// @param storage the storage to write
+    void write(const mutable_storage& storage)
+    {
+        write(const_storage(storage));
+    }
+
+    /// @copydoc write(const mutable_storage&)
+    void write(const const_storage& storage)
+    {
+        reserve_capacity(storage.m_size);
+        std::copy_n(storage.m_data, storage.m_size, m_data + m_position);
+        advance(storage.m_size);
+    }
+
+    /// Reserves room for a value at the current position and moves the
+    /// position past it. The value is written later using fill() or
+    /// fill_length().
+    /// @return handle to the reserved field
+    template<class ValueType>
+    reserved_field<ValueType> reserve()
+    {
+        reserve_capacity(sizeof(ValueType));
+        reserved_field<ValueType> field(m_position);
+        advance(sizeof(ValueType));
+        return field;
+    }
+
+    /// Writes the value of a reserved field without changing the current
+    /// position
+    /// @param field the reserved field
+    /// @param value the value to write
+    template<class ValueType>
+    void fill(const reserved_field<ValueType>& field,
+              typename reserved_field<ValueType>::value_type value)
+    {
+        assert(field.end() <= m_size);
+        big_endian::put<ValueType>(value, m_data + field.position());
+    }
+
+    /// Writes the number of bytes between the end of a reserved field
+    /// and the current position into the field
+    /// @param field the reserved field
+    template<class ValueType>
+    void fill_length(const reserved_field<ValueType>& field)
+    {
+        assert(field.end() <= m_position);
+        uint32_t length = m_position - field.end();
+
+        assert(length <= std::numeric_limits<ValueType>::max());
+        fill(field, static_cast<ValueType>(length));
+    }
+
+    /// Makes sure that at least the specified number of bytes can be
+    /// written at the current position without growing the buffer
+    /// @param bytes the number of bytes
+    void reserve_capacity(uint32_t bytes)
+    {
+        // Make sure the size of the stream fits in 32 bits
+        assert(bytes <= std::numeric_limits<uint32_t>::max() - m_position);
+
+        if (m_position + bytes > m_capacity)
+        {
+            grow(m_position + bytes);
+        }
+    }
+
+    /// Re-sizes the buffer to the number of bytes written
+    void trim()
+    {
+        if (m_capacity != m_size)
+        {
+            detail::resize_stream_buffer(m_buffer, m_size);
+            m_capacity = m_size;
+            m_data = m_size > 0 ? m_buffer.data() : 0;
+        }
+    }
+
+    /// @return the number of bytes in the buffer including any data
+    ///         which was in the buffer before the stream was created
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /// @return the number of bytes that can be stored before the
+    ///         buffer needs to grow
+    uint32_t capacity() const
+    {
+        return m_capacity;
+    }
+
+    /// @return the current write position in the buffer
+    uint32_t position() const
+    {
+        return m_position;
+    }
+
+    /// Changes the current write position in the buffer
+    /// @param new_position the new position
+    void seek(uint32_t new_position)
+    {
+        assert(new_position <= m_size);
+        m_position = new_position;
+    }
+
+private:
+
+    /// Moves the write position and the end of the data
+    void advance(uint32_t bytes)
+    {
+        m_position += bytes;
+        m_size = std::max(m_size, m_position);
+    }
+
+    /// Grows the buffer to at least the required size
+    /// @param required the required size in bytes
+    void grow(uint32_t required)
+    {
+        // Double the capacity without overflowing 32 bits
+        const uint32_t max = std::numeric_limits<uint32_t>::max();
+        uint32_t doubled = m_capacity > max / 2 ? max : 2 * m_capacity;
+
+        uint32_t capacity = std::max(std::max(doubled, required),
+                                     uint32_t(64));
+
+        detail::resize_stream_buffer(m_buffer, capacity);
+        m_capacity = capacity;
+        m_data = m_buffer.data();
+    }
+
+private:
+
+    /// The buffer written to
+    Buffer& m_buffer;
+
+    /// Pointer to the data of the buffer
+    uint8_t* m_data;
+
+    /// The number of bytes that fit in the buffer before it must grow
+    uint32_t m_capacity;
+
+    /// The number of bytes written
+    uint32_t m_size;
+
+    /// The current write position
+    uint32_t m_position;
+};
+}
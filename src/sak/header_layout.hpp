@@ -0,0 +1,212 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include <array>
+
+#include "convert_endian.hpp"
+
+namespace sak
+{
+// Do not expose implementation details to users of this header file
+namespace detail
+{
+// Builds a pack of byte indices in the same way as detail::build_indices
+// in easy_bind.hpp
+
+template<uint32_t... Is>
+struct header_indices {};
+
+template<uint32_t N, uint32_t... Is>
+struct build_header_indices : build_header_indices<N-1, N-1, Is...> {};
+
+template<uint32_t... Is>
+struct build_header_indices<0, Is...> : header_indices<Is...> {};
+
+/// @return true if the value can be stored in the number of bytes
+constexpr bool header_value_fits(uint32_t bytes, uint64_t value)
+{
+    return bytes >= 8 || (value >> (8 * bytes)) == 0;
+}
+
+/// Computes the size and offsets of the fields and the value of the
+/// individual bytes of a header at compile-time.
+template<uint32_t... Bytes>
+struct header_fields;
+
+template<uint32_t First, uint32_t... Rest>
+struct header_fields<First, Rest...>
+{
+    static_assert(First > 0 && First <= 8,
+                  "A header field must be between 1 and 8 bytes");
+
+    static constexpr uint32_t size()
+    {
+        return First + header_fields<Rest...>::size();
+    }
+
+    static constexpr uint32_t offset(uint32_t index)
+    {
+        return index == 0 ? 0 :
+               First + header_fields<Rest...>::offset(index - 1);
+    }
+
+    static constexpr uint32_t field_size(uint32_t index)
+    {
+        return index == 0 ? First :
+               header_fields<Rest...>::field_size(index - 1);
+    }
+
+    /// @return the byte at position index of the big-endian encoding
+    ///         of the fields
+    template<class... Values>
+    static constexpr uint8_t byte(uint32_t index, uint64_t value,
+                                  Values... rest)
+    {
+        return assert(header_value_fits(First, value)),
+               index < First ?
+               static_cast<uint8_t>(value >> (8 * (First - 1 - index))) :
+               header_fields<Rest...>::byte(index - First, rest...);
+    }
+};
+
+// The last field terminates the offset recursion
+template<uint32_t Last>
+struct header_fields<Last>
+{
+    static_assert(Last > 0 && Last <= 8,
+                  "A header field must be between 1 and 8 bytes");
+
+    static constexpr uint32_t size()
+    {
+        return Last;
+    }
+
+    static constexpr uint32_t offset(uint32_t index)
+    {
+        return index == 0 ? 0 : Last;
+    }
+
+    static constexpr uint32_t field_size(uint32_t)
+    {
+        return Last;
+    }
+
+    static constexpr uint8_t byte(uint32_t index, uint64_t value)
+    {
+        return assert(header_value_fits(Last, value)),
+               static_cast<uint8_t>(value >> (8 * (Last - 1 - index)));
+    }
+};
+}
+
+/// Describes a fixed protocol header as a sequence of big-endian fields,
+/// each given by its size in bytes (1 to 8). The layout makes it possible
+/// to build the header at compile-time. Hot code can then copy the
+/// precomputed template and only patch the fields that change.
+///
+/// Example:
+///
+///     // A 2-byte magic, a 1-byte version and a 3-byte length
+///     typedef sak::header_layout<2, 1, 3> my_header;
+///
+///     constexpr std::array<uint8_t, my_header::size> header_template =
+///         my_header::make(0xCAFE, 1, 0);
+///
+///     std::memcpy(buffer, header_template.data(), my_header::size);
+///     my_header::put<2>(payload_length, buffer);
+///
+template<uint32_t... Bytes>
+struct header_layout
+{
+    static_assert(sizeof...(Bytes) > 0, "A header needs at least one field");
+
+    /// The number of fields in the header
+    static constexpr uint32_t fields = sizeof...(Bytes);
+
+    /// The size of the header in bytes
+    static constexpr uint32_t size = detail::header_fields<Bytes...>::size();
+
+    /// The header type produced by make()
+    typedef std::array<uint8_t, size> header_type;
+
+    /// @return the offset in bytes of a field in the header
+    template<uint32_t Index>
+    static constexpr uint32_t offset()
+    {
+        static_assert(Index < fields, "Field index out of range");
+        return detail::header_fields<Bytes...>::offset(Index);
+    }
+
+    /// @return the size in bytes of a field in the header
+    template<uint32_t Index>
+    static constexpr uint32_t field_size()
+    {
+        static_assert(Index < fields, "Field index out of range");
+        return detail::header_fields<Bytes...>::field_size(Index);
+    }
+
+    /// Builds the header from the field values. The function can be
+    /// used in constant expressions. Each value must fit in the size of
+    /// its field.
+    /// @param values the value of each field
+    /// @return the encoded header
+    template<class... Values>
+    static constexpr header_type make(Values... values)
+    {
+        static_assert(sizeof...(Values) == fields,
+                      "A value must be given for each field");
+
+        return make_header(detail::build_header_indices<size> {},
+                    static_cast<uint64_t>(values)...);
+    }
+
+    /// Writes the value of a field into an encoded header
+    /// @param value the new value of the field, must fit in the size of
+    ///        the field
+    /// @param header pointer to the start of the header
+    template<uint32_t Index>
+    static void put(uint64_t value, uint8_t* header)
+    {
+        assert(header != 0);
+        assert(detail::header_value_fits(field_size<Index>(), value));
+        big_endian::put<field_size<Index>()>(
+            value, header + offset<Index>());
+    }
+
+    /// Reads the value of a field from an encoded header. The function
+    /// can be used in constant expressions.
+    /// @param header pointer to the start of the header
+    /// @return the value of the field
+    template<uint32_t Index>
+    static constexpr uint64_t get(const uint8_t* header)
+    {
+        return big_endian::get<field_size<Index>()>(
+            header + offset<Index>());
+    }
+
+private:
+
+    template<uint32_t... Is, class... Values>
+    static constexpr header_type make_header(
+        detail::header_indices<Is...>, Values... values)
+    {
+        return header_type
+        {{
+            detail::header_fields<Bytes...>::byte(Is, values...)...
+        }};
+    }
+};
+
+template<uint32_t... Bytes>
+constexpr uint32_t header_layout<Bytes...>::fields;
+
+template<uint32_t... Bytes>
+constexpr uint32_t header_layout<Bytes...>::size;
+}
@@ -6,7 +6,11 @@
 #pragma once
 
 #include <cstdint>
+#include <cassert>
 #include <functional>
+#include <string>
+
+#include "storage.hpp"
 
 namespace sak
 {
@@ -19,11 +23,36 @@ public:
     virtual ~input_stream()
     {}
 
-    /// Request a read from the io device
+    /// Request a read from the io device. A failed read is reported
+    /// through the error callback if one is set, otherwise by throwing.
+    /// A stream reporting the error through the callback does not move
+    /// past the failed read, so readers of a sak::finite_input_stream
+    /// detect the failure by checking the read position afterwards.
     /// @param buffer from where to read
     /// @param bytes to read
     virtual void read(uint8_t* buffer, uint32_t bytes) = 0;
 
+    /// Request a read from the io device into a sequence of storage
+    /// buffers, e.g. a header buffer followed by a number of symbol
+    /// buffers. The default implementation reads into the buffers one at
+    /// a time, implementations may override it to fill the whole
+    /// sequence at once.
+    /// @param first pointer to the first storage buffer
+    /// @param last pointer to the end of the storage sequence
+    virtual void read(const mutable_storage* first,
+                      const mutable_storage* last)
+    {
+        assert(first <= last);
+
+        for (; first != last; ++first)
+        {
+            if (first->m_size > 0)
+            {
+                read(first->m_data, first->m_size);
+            }
+        }
+    }
+
     /// Returns the number of bytes available for reading
     /// @return number of bytes available
     virtual uint32_t bytes_available() = 0;
@@ -34,6 +63,24 @@ public:
     /// return true.
     virtual bool stopped() = 0;
 
+    /// Returns the next bytes of the stream without moving past them.
+    /// Streams holding their data in memory return a storage pointing
+    /// directly to it, others copy the data into an internal buffer. The
+    /// storage is valid until the next call to a function of the stream.
+    /// Peeked data is still counted by bytes_available() and returned by
+    /// read(). sak::finite_input_stream implements peek() by reading and
+    /// seeking back, live streams can hold the peeked data in a
+    /// sak::peek_buffer.
+    /// @param max_bytes the maximum number of bytes to return
+    /// @return storage with the smaller of max_bytes and the number of
+    ///         bytes available
+    virtual const_storage peek(uint32_t max_bytes) = 0;
+
+    /// Moves past bytes returned by peek()
+    /// @param bytes the number of bytes, must not exceed the size of the
+    ///        storage returned by the last call to peek()
+    virtual void consume(uint32_t bytes) = 0;
+
 public:
 
     /// Signal emitted when data can be read
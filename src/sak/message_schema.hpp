@@ -0,0 +1,256 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <system_error>
+#include <type_traits>
+
+#include "convert_endian.hpp"
+#include "endian_stream.hpp"
+#include "error.hpp"
+
+namespace sak
+{
+/// Describes a single field of a message struct for use in a
+/// sak::message_schema. The field is stored in big-endian format using
+/// the specified number of bytes, which defaults to the size of the
+/// field type. A different size can be used for unsigned integer fields,
+/// e.g. to store a uint32_t as a 24-bit value.
+///
+/// @tparam Message the message struct
+/// @tparam FieldType the type of the field
+/// @tparam Member pointer to the member of the message struct
+/// @tparam Bytes the size of the field in the encoded message
+template<class Message, class FieldType, FieldType Message::* Member,
+         uint32_t Bytes = sizeof(FieldType)>
+struct schema_field
+{
+    static_assert(Bytes == sizeof(FieldType) ||
+                  (std::is_integral<FieldType>::value && Bytes <= 8),
+                  "Only integer fields can use a custom size");
+
+    static_assert(Bytes == sizeof(FieldType) ||
+                  std::is_unsigned<FieldType>::value,
+                  "Signed fields cannot use a custom size");
+
+    /// The size of the field in the encoded message
+    static constexpr uint32_t size = Bytes;
+
+    /// Writes the field of the message to the buffer
+    /// @param message the message
+    /// @param buffer pointer to the position of the field in the buffer
+    static void put(const Message& message, uint8_t* buffer)
+    {
+        put(message.*Member, buffer,
+            std::integral_constant<bool, Bytes == sizeof(FieldType)>());
+    }
+
+    /// Reads the field of the message from the buffer
+    /// @param buffer pointer to the position of the field in the buffer
+    /// @param message the message
+    static void get(const uint8_t* buffer, Message& message)
+    {
+        message.*Member = get(buffer,
+            std::integral_constant<bool, Bytes == sizeof(FieldType)>());
+    }
+
+private:
+
+    static void put(FieldType value, uint8_t* buffer, std::true_type)
+    {
+        big_endian::put<FieldType>(value, buffer);
+    }
+
+    static void put(FieldType value, uint8_t* buffer, std::false_type)
+    {
+        big_endian::put<Bytes>(static_cast<uint64_t>(value), buffer);
+    }
+
+    static FieldType get(const uint8_t* buffer, std::true_type)
+    {
+        return big_endian::get<FieldType>(buffer);
+    }
+
+    static FieldType get(const uint8_t* buffer, std::false_type)
+    {
+        return static_cast<FieldType>(big_endian::get<Bytes>(buffer));
+    }
+};
+
+template<class Message, class FieldType, FieldType Message::* Member,
+         uint32_t Bytes>
+constexpr uint32_t schema_field<Message, FieldType, Member, Bytes>::size;
+
+// Do not expose implementation details to users of this header file
+namespace detail
+{
+/// Encodes and decodes the fields at compile-time offsets
+template<uint32_t Offset, class... Fields>
+struct schema_codec;
+
+template<uint32_t Offset>
+struct schema_codec<Offset>
+{
+    static constexpr uint32_t size()
+    {
+        return Offset;
+    }
+
+    template<class Message>
+    static void encode(const Message&, uint8_t*)
+    { }
+
+    template<class Message>
+    static void decode(const uint8_t*, Message&)
+    { }
+};
+
+template<uint32_t Offset, class First, class... Rest>
+struct schema_codec<Offset, First, Rest...>
+{
+    typedef schema_codec<Offset + First::size, Rest...> next;
+
+    static constexpr uint32_t size()
+    {
+        return next::size();
+    }
+
+    template<class Message>
+    static void encode(const Message& message, uint8_t* buffer)
+    {
+        First::put(message, buffer + Offset);
+        next::encode(message, buffer);
+    }
+
+    template<class Message>
+    static void decode(const uint8_t* buffer, Message& message)
+    {
+        First::get(buffer + Offset, message);
+        next::decode(buffer, message);
+    }
+};
+}
+
+/// The message_schema declares the wire format of a message struct once
+/// and generates the functions for encoding and decoding it. The fields
+/// are stored in the order given, without padding, in big-endian format.
+///
+/// Since the size of the message and the offset of every field are known
+/// at compile-time, the generated code checks the bounds once per message
+/// and writes every field at a constant offset, which allows the
+/// compiler to merge the stores of adjacent fields.
+///
+/// Example:
+///
+///     struct header
+///     {
+///         uint16_t m_type;
+///         uint32_t m_length;
+///         uint64_t m_timestamp;
+///     };
+///
+///     typedef sak::message_schema<header,
+///         sak::schema_field<header, uint16_t, &header::m_type>,
+///         sak::schema_field<header, uint32_t, &header::m_length, 3>,
+///         sak::schema_field<header, uint64_t, &header::m_timestamp>>
+///         header_schema;
+///
+///     static_assert(header_schema::size == 13, "");
+///
+///     header_schema::write(stream, h);
+///
+template<class Message, class... Fields>
+struct message_schema
+{
+    /// The message type
+    typedef Message message_type;
+
+    /// The size of the encoded message in bytes
+    static constexpr uint32_t size =
+        detail::schema_codec<0, Fields...>::size();
+
+    /// Encodes a message into a buffer
+    /// @param message the message to encode
+    /// @param buffer the buffer, must have room for size bytes
+    static void encode(const Message& message, uint8_t* buffer)
+    {
+        assert(buffer != 0);
+        detail::schema_codec<0, Fields...>::encode(message, buffer);
+    }
+
+    /// Decodes a message from a buffer
+    /// @param buffer the buffer, must contain at least size bytes
+    /// @param message the decoded message
+    static void decode(const uint8_t* buffer, Message& message)
+    {
+        assert(buffer != 0);
+        detail::schema_codec<0, Fields...>::decode(buffer, message);
+    }
+
+    /// Writes a message to an endian_stream
+    /// @param stream the stream to write to
+    /// @param message the message to write
+    static void write(endian_stream& stream, const Message& message)
+    {
+        // Make sure there is enough space in the underlying buffer
+        assert(stream.remaining_size() >= size);
+        encode(message, stream.data() + stream.position());
+        stream.seek(stream.position() + size);
+    }
+
+    /// Writes a message to an endian_stream
+    /// @param stream the stream to write to
+    /// @param message the message to write
+    /// @param ec set to error::insufficient_space if the message does
+    ///        not fit in the stream
+    static void write(endian_stream& stream, const Message& message,
+                      std::error_code& ec)
+    {
+        if (stream.remaining_size() < size)
+        {
+            ec = error::insufficient_space;
+            stream.seek(stream.size());
+            return;
+        }
+
+        write(stream, message);
+    }
+
+    /// Reads a message from an endian_stream
+    /// @param stream the stream to read from
+    /// @param message the message to read
+    static void read(endian_stream& stream, Message& message)
+    {
+        // Make sure there is enough data to read in the underlying buffer
+        assert(stream.remaining_size() >= size);
+        decode(stream.data() + stream.position(), message);
+        stream.seek(stream.position() + size);
+    }
+
+    /// Reads a message from an endian_stream
+    /// @param stream the stream to read from
+    /// @param message the message to read
+    /// @param ec set to error::insufficient_data if the stream does not
+    ///        contain the message
+    static void read(endian_stream& stream, Message& message,
+                     std::error_code& ec)
+    {
+        if (stream.remaining_size() < size)
+        {
+            ec = error::insufficient_data;
+            stream.seek(stream.size());
+            return;
+        }
+
+        read(stream, message);
+    }
+};
+
+template<class Message, class... Fields>
+constexpr uint32_t message_schema<Message, Fields...>::size;
+}
@@ -0,0 +1,226 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "mmap_input_stream.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sak
+{
+mmap_input_stream::mmap_input_stream() :
+    m_fd(-1),
+    m_data(0),
+    m_size(0),
+    m_position(0)
+{ }
+
+mmap_input_stream::mmap_input_stream(const std::string& filename,
+                                     bool populate) :
+    mmap_input_stream()
+{
+    open(filename, populate);
+}
+
+mmap_input_stream::~mmap_input_stream()
+{
+    if (is_open())
+    {
+        close();
+    }
+}
+
+void mmap_input_stream::open(const std::string& filename, bool populate)
+{
+    assert(!is_open());
+
+    std::error_code ec;
+    open(filename, populate, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void mmap_input_stream::open(const std::string& filename,
+                             std::error_code& ec)
+{
+    open(filename, false, ec);
+}
+
+void mmap_input_stream::open(const std::string& filename, bool populate,
+                             std::error_code& ec)
+{
+    assert(!is_open());
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        ec = error::failed_open_file;
+        return;
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        ec = error::failed_open_file;
+        return;
+    }
+
+    // The size of the stream is limited to 32 bits
+    if ((uint64_t)status.st_size > std::numeric_limits<uint32_t>::max())
+    {
+        ::close(fd);
+        ec = error::file_too_large;
+        return;
+    }
+
+    uint32_t size = (uint32_t)status.st_size;
+    void* data = 0;
+
+    // An empty file cannot be mapped
+    if (size > 0)
+    {
+        int flags = MAP_PRIVATE;
+#if defined(MAP_POPULATE)
+        if (populate)
+        {
+            flags |= MAP_POPULATE;
+        }
+#else
+        (void) populate;
+#endif
+        data = ::mmap(0, size, PROT_READ, flags, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            ec = error::failed_open_file;
+            return;
+        }
+    }
+
+    m_fd = fd;
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = size;
+    m_position = 0;
+}
+
+void mmap_input_stream::close()
+{
+    assert(is_open());
+
+    if (m_data != 0)
+    {
+        ::munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+
+    ::close(m_fd);
+
+    m_fd = -1;
+    m_data = 0;
+    m_size = 0;
+    m_position = 0;
+}
+
+bool mmap_input_stream::is_open() const
+{
+    return m_fd >= 0;
+}
+
+void mmap_input_stream::advise(access_pattern pattern)
+{
+    assert(is_open());
+
+    if (m_data == 0)
+        return;
+
+    int advice = MADV_NORMAL;
+
+    switch (pattern)
+    {
+    case access_pattern::normal:
+        advice = MADV_NORMAL;
+        break;
+    case access_pattern::sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case access_pattern::random:
+        advice = MADV_RANDOM;
+        break;
+    case access_pattern::willneed:
+        advice = MADV_WILLNEED;
+        break;
+    }
+
+    // The advice is only a hint, so errors are ignored
+    ::madvise(const_cast<uint8_t*>(m_data), m_size, advice);
+}
+
+const uint8_t* mmap_input_stream::data() const
+{
+    return m_data;
+}
+
+void mmap_input_stream::seek(uint32_t pos)
+{
+    assert(is_open());
+    assert(pos <= m_size);
+    m_position = pos;
+}
+
+uint32_t mmap_input_stream::read_position()
+{
+    assert(is_open());
+    return m_position;
+}
+
+uint32_t mmap_input_stream::size()
+{
+    assert(is_open());
+    return m_size;
+}
+
+void mmap_input_stream::read(uint8_t* buffer, uint32_t bytes)
+{
+    assert(is_open());
+    assert(buffer != 0);
+    assert(m_position + bytes <= m_size);
+
+    std::copy_n(m_data + m_position, bytes, buffer);
+    m_position += bytes;
+}
+
+uint32_t mmap_input_stream::bytes_available()
+{
+    assert(is_open());
+    return m_size - m_position;
+}
+
+const_storage mmap_input_stream::peek(uint32_t max_bytes)
+{
+    uint32_t bytes = std::min(max_bytes, bytes_available());
+    return const_storage(m_data + m_position, bytes);
+}
+
+void mmap_input_stream::consume(uint32_t bytes)
+{
+    assert(bytes <= bytes_available());
+    m_position += bytes;
+}
+}
+
+#endif
@@ -0,0 +1,132 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "sak::mmap_input_stream requires a POSIX platform"
+#endif
+
+#include <cstdint>
+#include <cassert>
+#include <string>
+#include <system_error>
+
+#include "access_pattern.hpp"
+#include "error.hpp"
+#include "finite_input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// A file input stream reading local files through a read-only memory
+/// mapping. The stream is only available on POSIX platforms.
+///
+/// Besides the copying read() of the input_stream, the stream provides
+/// the zero-copy peek() which returns a storage pointing directly into
+/// the mapping, the storage is valid until the stream is closed. Reading
+/// or seeking does not involve any system calls, which makes random
+/// access into large files cheap.
+class mmap_input_stream : public finite_input_stream
+{
+public:
+
+    /// Constructor
+    mmap_input_stream();
+
+    /// Constructor that opens the file immediately
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the filename
+    /// @param populate if true the whole file is read into memory when
+    ///        it is opened (MAP_POPULATE), where supported
+    mmap_input_stream(const std::string& filename, bool populate = false);
+
+    /// Destructor, closes the file if it is open
+    ~mmap_input_stream();
+
+    /// The stream is not copyable
+    mmap_input_stream(const mmap_input_stream&) = delete;
+
+    /// The stream is not copyable
+    mmap_input_stream& operator=(const mmap_input_stream&) = delete;
+
+    /// Opens and maps the file
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the file name
+    /// @param populate if true the whole file is read into memory when
+    ///        it is opened (MAP_POPULATE), where supported
+    void open(const std::string& filename, bool populate = false);
+
+    /// Opens and maps the file
+    /// @param filename the file name
+    /// @param ec on error set to indicate the type of error, files of
+    ///        4 GiB or more are rejected with error::file_too_large
+    void open(const std::string& filename, std::error_code& ec);
+
+    /// Opens and maps the file
+    /// @param filename the file name
+    /// @param populate if true the whole file is read into memory when
+    ///        it is opened (MAP_POPULATE), where supported
+    /// @param ec on error set to indicate the type of error, files of
+    ///        4 GiB or more are rejected with error::file_too_large
+    void open(const std::string& filename, bool populate,
+              std::error_code& ec);
+
+    /// Unmaps and closes the file
+    void close();
+
+    /// @return true if a file is open
+    bool is_open() const;
+
+    /// Tells the operating system how the mapping will be accessed
+    /// @param pattern the access pattern
+    void advise(access_pattern pattern);
+
+    /// @return a pointer to the start of the mapping, 0 if the file is
+    ///         empty
+    const uint8_t* data() const;
+
+public: // From finite_input_stream
+
+    /// @copydoc finite_input_stream::seek()
+    void seek(uint32_t pos);
+
+    /// @copydoc finite_input_stream::read_position()
+    uint32_t read_position();
+
+    /// @copydoc finite_input_stream::size()
+    uint32_t size();
+
+public: // From input_stream
+
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
+    void read(uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc input_stream::bytes_available()
+    uint32_t bytes_available();
+
+    /// @copydoc input_stream::peek()
+    const_storage peek(uint32_t max_bytes);
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes);
+
+private:
+
+    /// The file descriptor, -1 if no file is open
+    int m_fd;
+
+    /// Pointer to the mapping
+    const uint8_t* m_data;
+
+    /// The size of the mapping in bytes
+    uint32_t m_size;
+
+    /// The current read position
+    uint32_t m_position;
+};
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+
+#include "storage.hpp"
+
+namespace sak
+{
+/// Output stream abstraction
+class output_stream
+{
+public:
+
+    /// Destructor
+    virtual ~output_stream()
+    {}
+
+    /// Request a write to the io device
+    /// @param buffer the data to write
+    /// @param bytes the number of bytes to write
+    virtual void write(const uint8_t* buffer, uint32_t bytes) = 0;
+
+    /// Request a write of a sequence of storage buffers to the io device.
+    /// The default implementation writes the buffers one at a time,
+    /// implementations may override it to write the whole sequence at
+    /// once.
+    /// @param first pointer to the first storage buffer
+    /// @param last pointer to the end of the storage sequence
+    virtual void write(const const_storage* first, const const_storage* last)
+    {
+        assert(first <= last);
+
+        for (; first != last; ++first)
+        {
+            if (first->m_size > 0)
+            {
+                write(first->m_data, first->m_size);
+            }
+        }
+    }
+
+    /// Writes any data buffered by the stream to the io device
+    virtual void flush()
+    {}
+};
+}
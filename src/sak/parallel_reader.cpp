@@ -0,0 +1,223 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "parallel_reader.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "ceil_division.hpp"
+#include "error.hpp"
+
+namespace sak
+{
+namespace
+{
+/// A block read by a worker
+struct block
+{
+    /// The index of the block
+    uint32_t m_index;
+
+    /// The buffer holding the data
+    std::vector<uint8_t>* m_buffer;
+};
+}
+
+parallel_reader::parallel_reader(const stream_factory& factory,
+                                 uint32_t block_size, uint32_t threads) :
+    m_size(0),
+    m_block_size(block_size),
+    m_blocks(0)
+{
+    assert(factory);
+    assert(block_size > 0);
+    assert(threads > 0);
+
+    for (uint32_t i = 0; i < threads; ++i)
+    {
+        m_streams.push_back(factory());
+        assert(m_streams.back());
+    }
+
+    m_size = m_streams.front()->size();
+    m_blocks = ceil_division(m_size, m_block_size);
+}
+
+void parallel_reader::read(const block_callback& callback, bool in_order)
+{
+    assert(callback);
+
+    // Each worker can have one block in flight and one waiting
+    const uint32_t window = 2 * (uint32_t)m_streams.size();
+
+    std::vector<std::vector<uint8_t>> buffers(
+        std::min(window, m_blocks), std::vector<uint8_t>(m_block_size));
+
+    std::vector<std::vector<uint8_t>*> free_buffers;
+    for (auto& buffer : buffers)
+    {
+        free_buffers.push_back(&buffer);
+    }
+
+    std::mutex mutex;
+    std::condition_variable block_read;
+    std::condition_variable block_delivered;
+
+    uint32_t next = 0;
+    uint32_t delivered = 0;
+    bool abort = false;
+
+    // The exception of the first worker which failed to read a block
+    std::exception_ptr failure;
+
+    // The blocks read, by index for in-order delivery
+    std::map<uint32_t, block> completed;
+
+    auto work = [&](finite_input_stream* stream)
+    {
+        while (true)
+        {
+            block current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                block_delivered.wait(lock, [&]()
+                {
+                    return abort || next >= m_blocks ||
+                        next < delivered + window;
+                });
+
+                if (abort || next >= m_blocks)
+                    return;
+
+                current.m_index = next++;
+                current.m_buffer = free_buffers.back();
+                free_buffers.pop_back();
+            }
+
+            uint32_t offset = current.m_index * m_block_size;
+            uint32_t bytes = std::min(m_block_size, m_size - offset);
+
+            try
+            {
+                stream->seek(offset);
+                stream->read(current.m_buffer->data(), bytes);
+
+                // Streams reporting errors through the error callback
+                // do not throw, but do not move past the failed read
+                if (stream->read_position() != offset + bytes)
+                    error::throw_error(error::failed_read_file);
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failure)
+                        failure = std::current_exception();
+                    abort = true;
+                }
+                block_read.notify_one();
+                block_delivered.notify_all();
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed[current.m_index] = current;
+            }
+            block_read.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto& stream : m_streams)
+    {
+        workers.emplace_back(work, stream.get());
+    }
+
+    try
+    {
+        while (delivered < m_blocks)
+        {
+            block current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                block_read.wait(lock, [&]()
+                {
+                    return failure || (in_order ?
+                        completed.count(delivered) > 0 : !completed.empty());
+                });
+
+                if (failure)
+                    std::rethrow_exception(failure);
+
+                auto it = in_order ? completed.find(delivered) :
+                    completed.begin();
+
+                current = it->second;
+                completed.erase(it);
+            }
+
+            uint32_t offset = current.m_index * m_block_size;
+            uint32_t bytes = std::min(m_block_size, m_size - offset);
+
+            callback(current.m_index,
+                     const_storage(current.m_buffer->data(), bytes));
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                free_buffers.push_back(current.m_buffer);
+                ++delivered;
+            }
+            block_delivered.notify_all();
+        }
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            abort = true;
+        }
+        block_delivered.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        throw;
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+uint32_t parallel_reader::size() const
+{
+    return m_size;
+}
+
+uint32_t parallel_reader::block_size() const
+{
+    return m_block_size;
+}
+
+uint32_t parallel_reader::blocks() const
+{
+    return m_blocks;
+}
+
+uint32_t parallel_reader::threads() const
+{
+    return (uint32_t)m_streams.size();
+}
+}
@@ -0,0 +1,100 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "finite_input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// Reads a finite stream using a number of worker threads.
+///
+/// The stream is split into blocks of a fixed size, where the last block
+/// may be smaller. Every worker thread reads whole blocks using its own
+/// stream, which is positioned with seek() before each read. The streams
+/// are created by a factory function, e.g. opening a
+/// sak::pread_file_input_stream on the same file, which reads with pread().
+///
+/// The blocks are delivered to a callback on the thread calling read(),
+/// either in stream order or in the order they complete. At most two
+/// blocks per worker are buffered, so the memory usage does not depend
+/// on the size of the stream.
+///
+/// Example:
+///
+///     sak::parallel_reader reader([]()
+///     {
+///         return std::make_shared<sak::pread_file_input_stream>("data.bin");
+///     }, 1 << 20, 4);
+///
+///     reader.read([](uint32_t index, const sak::const_storage& block)
+///     {
+///         process(index, block);
+///     });
+///
+class parallel_reader
+{
+public:
+
+    /// Function creating a stream for a worker thread
+    typedef std::function<finite_input_stream::ptr()> stream_factory;
+
+    /// Function receiving a block, the index of the block multiplied by
+    /// the block size gives its offset in the stream
+    typedef std::function<void(uint32_t, const const_storage&)>
+        block_callback;
+
+public:
+
+    /// Constructor, creates the streams of the workers
+    /// @param factory function creating the streams, all streams must
+    ///        contain the same data
+    /// @param block_size the size of the blocks in bytes
+    /// @param threads the number of worker threads
+    parallel_reader(const stream_factory& factory, uint32_t block_size,
+                    uint32_t threads);
+
+    /// Reads the stream and delivers the blocks to the callback
+    /// @param callback the function receiving the blocks
+    /// @param in_order if true the blocks are delivered in stream order,
+    ///        otherwise in the order in which they complete
+    /// @throws the exception of the first worker whose read failed, or
+    ///         std::system_error with error::failed_read_file if the
+    ///         stream did not move past the block. The remaining blocks
+    ///         are not delivered.
+    void read(const block_callback& callback, bool in_order = true);
+
+    /// @return the size of the stream in bytes
+    uint32_t size() const;
+
+    /// @return the size of the blocks in bytes
+    uint32_t block_size() const;
+
+    /// @return the number of blocks in the stream
+    uint32_t blocks() const;
+
+    /// @return the number of worker threads
+    uint32_t threads() const;
+
+private:
+
+    /// The streams of the workers
+    std::vector<finite_input_stream::ptr> m_streams;
+
+    /// The size of the stream
+    uint32_t m_size;
+
+    /// The size of the blocks
+    uint32_t m_block_size;
+
+    /// The number of blocks
+    uint32_t m_blocks;
+};
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "peek_buffer.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+namespace sak
+{
+peek_buffer::peek_buffer() :
+    m_begin(0),
+    m_end(0),
+    m_prepared(0)
+{ }
+
+uint32_t peek_buffer::size() const
+{
+    return m_end - m_begin;
+}
+
+const_storage peek_buffer::data(uint32_t max_bytes) const
+{
+    return const_storage(m_data.data() + m_begin,
+                         std::min(max_bytes, size()));
+}
+
+uint8_t* peek_buffer::prepare(uint32_t bytes)
+{
+    // Move the data to the front once the consumed bytes make up half
+    // of the buffer
+    if (m_begin > 0 && m_begin >= size())
+    {
+        std::memmove(m_data.data(), m_data.data() + m_begin, size());
+        m_end -= m_begin;
+        m_begin = 0;
+    }
+
+    if (m_data.size() < m_end + bytes)
+    {
+        m_data.resize(m_end + bytes);
+    }
+
+    m_prepared = bytes;
+    return m_data.data() + m_end;
+}
+
+void peek_buffer::commit(uint32_t bytes)
+{
+    assert(bytes <= m_prepared);
+
+    m_end += bytes;
+    m_prepared = 0;
+}
+
+uint32_t peek_buffer::read(uint8_t* buffer, uint32_t bytes)
+{
+    assert(buffer != 0);
+
+    bytes = std::min(bytes, size());
+    std::copy_n(m_data.data() + m_begin, bytes, buffer);
+    consume(bytes);
+
+    return bytes;
+}
+
+void peek_buffer::consume(uint32_t bytes)
+{
+    assert(bytes <= size());
+
+    m_begin += bytes;
+
+    if (m_begin == m_end)
+    {
+        m_begin = 0;
+        m_end = 0;
+    }
+}
+}
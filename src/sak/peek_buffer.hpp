@@ -0,0 +1,70 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "storage.hpp"
+
+namespace sak
+{
+/// Helper class holding the data peeked from a live input stream which
+/// cannot move its read position back. The stream appends the data it
+/// reads ahead using prepare() and commit(), returns it from peek() and
+/// serves its read() calls from the buffer before reading new data.
+///
+/// The consumed bytes are only moved out of the way once they make up
+/// half of the buffer, so each byte is moved at most once on average.
+class peek_buffer
+{
+public:
+
+    /// Constructs an empty buffer
+    peek_buffer();
+
+    /// @return the number of bytes in the buffer
+    uint32_t size() const;
+
+    /// @param max_bytes the maximum number of bytes to return
+    /// @return storage with the smaller of max_bytes and size() bytes
+    const_storage data(uint32_t max_bytes) const;
+
+    /// Makes room for appending data to the buffer
+    /// @param bytes the number of bytes to append
+    /// @return pointer to where the bytes must be written
+    uint8_t* prepare(uint32_t bytes);
+
+    /// Adds bytes written to the pointer returned by prepare()
+    /// @param bytes the number of bytes written, must not exceed the size
+    ///        given to prepare()
+    void commit(uint32_t bytes);
+
+    /// Copies bytes out of the buffer and removes them
+    /// @param buffer the destination
+    /// @param bytes the maximum number of bytes to copy
+    /// @return the number of bytes copied
+    uint32_t read(uint8_t* buffer, uint32_t bytes);
+
+    /// Removes bytes from the front of the buffer
+    /// @param bytes the number of bytes, must not exceed size()
+    void consume(uint32_t bytes);
+
+private:
+
+    /// The storage of the buffer
+    std::vector<uint8_t> m_data;
+
+    /// The offset of the first byte in the buffer
+    uint32_t m_begin;
+
+    /// The offset past the last byte in the buffer
+    uint32_t m_end;
+
+    /// The number of bytes passed to the last prepare()
+    uint32_t m_prepared;
+};
+}
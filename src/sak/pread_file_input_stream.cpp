@@ -0,0 +1,462 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "pread_file_input_stream.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <algorithm>
+#include <limits>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+#include "error.hpp"
+
+namespace sak
+{
+namespace
+{
+/// The largest number of buffers passed to a single preadv() call
+const uint32_t max_batch = IOV_MAX < 64 ? IOV_MAX : 64;
+
+/// Reads into a number of buffers, older versions of macOS and iOS do
+/// not provide preadv() so only the first buffer is filled there, which
+/// the caller handles like any other partial read
+ssize_t read_vector(int fd, const iovec* vec, uint32_t count,
+                    uint32_t offset)
+{
+#if defined(__APPLE__)
+    (void)count;
+    return ::pread(fd, vec->iov_base, vec->iov_len, offset);
+#else
+    return ::preadv(fd, vec, (int)count, offset);
+#endif
+}
+
+/// Reads into a number of buffers, retrying after partial reads and
+/// interrupts
+/// @return the number of bytes read, less than the size of the buffers
+///         if the end of the file was reached or an error occurred
+uint32_t read_all(int fd, iovec* vec, uint32_t count, uint32_t offset)
+{
+    uint32_t total = 0;
+
+    while (count > 0)
+    {
+        ssize_t result = read_vector(fd, vec, count, offset + total);
+
+        if (result < 0 && errno == EINTR)
+            continue;
+
+        if (result <= 0)
+            break;
+
+        total += (uint32_t)result;
+
+        // Skip the buffers which were completely filled
+        size_t remaining = (size_t)result;
+        while (count > 0 && remaining >= vec->iov_len)
+        {
+            remaining -= vec->iov_len;
+            ++vec;
+            --count;
+        }
+
+        if (remaining > 0)
+        {
+            vec->iov_base = static_cast<uint8_t*>(vec->iov_base) + remaining;
+            vec->iov_len -= remaining;
+        }
+    }
+
+    return total;
+}
+}
+
+pread_file_input_stream::pread_file_input_stream(uint32_t buffer_size) :
+    m_fd(-1),
+    m_filesize(0),
+    m_position(0),
+    m_buffer(buffer_size),
+    m_buffer_offset(0),
+    m_buffered(0),
+    m_bypass_buffer(buffer_size == 0)
+{ }
+
+pread_file_input_stream::pread_file_input_stream(
+    const std::string& filename, uint32_t buffer_size) :
+    pread_file_input_stream(buffer_size)
+{
+    open(filename);
+}
+
+pread_file_input_stream::~pread_file_input_stream()
+{
+    if (is_open())
+    {
+        close();
+    }
+}
+
+void pread_file_input_stream::open(const std::string& filename)
+{
+    assert(!is_open());
+
+    std::error_code ec;
+    open(filename, ec);
+
+    // If an error occurs, throw that
+    if (ec)
+    {
+        error::throw_error(ec);
+    }
+}
+
+void pread_file_input_stream::open(const std::string& filename,
+                                   std::error_code& ec)
+{
+    assert(!is_open());
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        ec = error::failed_open_file;
+        return;
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || !S_ISREG(status.st_mode))
+    {
+        ::close(fd);
+        ec = error::failed_open_file;
+        return;
+    }
+
+    // The size of the stream is limited to 32 bits
+    if ((uint64_t)status.st_size > std::numeric_limits<uint32_t>::max())
+    {
+        ::close(fd);
+        ec = error::file_too_large;
+        return;
+    }
+
+    m_fd = fd;
+    m_filesize = (uint32_t)status.st_size;
+    m_position = 0;
+    m_buffer_offset = 0;
+    m_buffered = 0;
+}
+
+void pread_file_input_stream::close()
+{
+    assert(is_open());
+
+    ::close(m_fd);
+    m_fd = -1;
+    m_buffered = 0;
+}
+
+bool pread_file_input_stream::is_open() const
+{
+    return m_fd >= 0;
+}
+
+void pread_file_input_stream::advise(access_pattern pattern)
+{
+    assert(is_open());
+
+    m_bypass_buffer =
+        pattern == access_pattern::random || m_buffer.size() == 0;
+
+#if defined(POSIX_FADV_NORMAL)
+    int advice = POSIX_FADV_NORMAL;
+
+    switch (pattern)
+    {
+    case access_pattern::normal:
+        advice = POSIX_FADV_NORMAL;
+        break;
+    case access_pattern::sequential:
+        advice = POSIX_FADV_SEQUENTIAL;
+        break;
+    case access_pattern::random:
+        advice = POSIX_FADV_RANDOM;
+        break;
+    case access_pattern::willneed:
+        advice = POSIX_FADV_WILLNEED;
+        break;
+    }
+
+    // The advice is only a hint, so errors are ignored
+    ::posix_fadvise(m_fd, 0, 0, advice);
+#endif
+}
+
+void pread_file_input_stream::seek(uint32_t pos)
+{
+    assert(is_open());
+    assert(pos <= m_filesize);
+
+    // The internal buffer stays valid, it is used again if the new
+    // position falls within it
+    m_position = pos;
+}
+
+uint32_t pread_file_input_stream::read_position()
+{
+    assert(is_open());
+    return m_position;
+}
+
+void pread_file_input_stream::read(uint8_t* buffer, uint32_t bytes,
+                                   std::error_code& ec)
+{
+    assert(is_open());
+    assert(buffer != 0);
+    assert(bytes <= m_filesize - m_position);
+
+    uint32_t position = m_position;
+
+    // Use the data in the internal buffer first
+    if (buffered(position, 1))
+    {
+        uint32_t offset = position - m_buffer_offset;
+        uint32_t copy = std::min(bytes, m_buffered - offset);
+
+        std::copy_n(m_buffer.data() + offset, copy, buffer);
+
+        buffer += copy;
+        bytes -= copy;
+        position += copy;
+    }
+
+    if (bytes > 0)
+    {
+        // Large reads go directly to the caller's buffer
+        if (m_bypass_buffer || bytes >= m_buffer.size())
+        {
+            if (read_at(buffer, bytes, position) < bytes)
+            {
+                ec = error::failed_read_file;
+                return;
+            }
+        }
+        else
+        {
+            refill(position, ec);
+
+            if (ec)
+                return;
+
+            std::copy_n(m_buffer.data(), bytes, buffer);
+        }
+
+        position += bytes;
+    }
+
+    m_position = position;
+}
+
+void pread_file_input_stream::read(const mutable_storage* first,
+                                   const mutable_storage* last,
+                                   std::error_code& ec)
+{
+    assert(is_open());
+    assert(first <= last);
+
+    uint32_t bytes = storage_size(first, last);
+    assert(bytes <= m_filesize - m_position);
+
+    if (bytes == 0)
+        return;
+
+    bool in_buffer = buffered(m_position, bytes);
+
+    // Large reads fill the whole sequence directly from the file
+    if (!in_buffer && (m_bypass_buffer || bytes >= m_buffer.size()))
+    {
+        if (read_at(first, last, m_position) < bytes)
+        {
+            ec = error::failed_read_file;
+            return;
+        }
+
+        m_position += bytes;
+        return;
+    }
+
+    // Small reads are copied from the internal buffer
+    if (!in_buffer)
+    {
+        refill(m_position, ec);
+
+        if (ec)
+            return;
+    }
+
+    const uint8_t* data = m_buffer.data() + (m_position - m_buffer_offset);
+
+    for (; first != last; ++first)
+    {
+        std::copy_n(data, first->m_size, first->m_data);
+        data += first->m_size;
+    }
+
+    m_position += bytes;
+}
+
+void pread_file_input_stream::read(uint8_t* buffer, uint32_t bytes)
+{
+    std::error_code ec;
+    read(buffer, bytes, ec);
+
+    if (ec)
+    {
+        report(ec);
+    }
+}
+
+void pread_file_input_stream::read(const mutable_storage* first,
+                                   const mutable_storage* last)
+{
+    std::error_code ec;
+    read(first, last, ec);
+
+    if (ec)
+    {
+        report(ec);
+    }
+}
+
+uint32_t pread_file_input_stream::bytes_available()
+{
+    assert(is_open());
+    assert(m_position <= m_filesize);
+
+    return m_filesize - m_position;
+}
+
+const_storage pread_file_input_stream::peek(uint32_t max_bytes)
+{
+    assert(is_open());
+
+    uint32_t bytes = std::min(max_bytes, m_filesize - m_position);
+
+    if (m_bypass_buffer || bytes > m_buffer.size())
+    {
+        return finite_input_stream::peek(max_bytes);
+    }
+
+    if (!buffered(m_position, bytes))
+    {
+        std::error_code ec;
+        refill(m_position, ec);
+
+        if (ec)
+        {
+            report(ec);
+            return const_storage();
+        }
+    }
+
+    return const_storage(m_buffer.data() + (m_position - m_buffer_offset),
+                         bytes);
+}
+
+uint32_t pread_file_input_stream::size()
+{
+    assert(is_open());
+    return m_filesize;
+}
+
+bool pread_file_input_stream::buffered(uint32_t offset,
+                                       uint32_t bytes) const
+{
+    return offset >= m_buffer_offset &&
+        offset - m_buffer_offset + bytes <= m_buffered;
+}
+
+void pread_file_input_stream::refill(uint32_t offset, std::error_code& ec)
+{
+    uint32_t bytes =
+        std::min<uint32_t>(m_buffer.size(), m_filesize - offset);
+
+    m_buffer_offset = offset;
+    m_buffered = read_at(m_buffer.data(), bytes, offset);
+
+    if (m_buffered < bytes)
+    {
+        m_buffered = 0;
+        ec = error::failed_read_file;
+    }
+}
+
+void pread_file_input_stream::report(const std::error_code& ec)
+{
+    if (m_error_callback)
+    {
+        m_error_callback(ec.message());
+        return;
+    }
+
+    error::throw_error(ec);
+}
+
+uint32_t pread_file_input_stream::read_at(uint8_t* buffer, uint32_t bytes,
+                                          uint32_t offset)
+{
+    iovec vec;
+    vec.iov_base = buffer;
+    vec.iov_len = bytes;
+
+    return read_all(m_fd, &vec, 1, offset);
+}
+
+uint32_t pread_file_input_stream::read_at(const mutable_storage* first,
+                                          const mutable_storage* last,
+                                          uint32_t offset)
+{
+    iovec vec[max_batch];
+    uint32_t total = 0;
+
+    while (first != last)
+    {
+        uint32_t count = 0;
+        uint32_t bytes = 0;
+
+        for (; first != last && count < max_batch; ++first)
+        {
+            if (first->m_size == 0)
+                continue;
+
+            vec[count].iov_base = first->m_data;
+            vec[count].iov_len = first->m_size;
+            bytes += first->m_size;
+            ++count;
+        }
+
+        uint32_t result = read_all(m_fd, vec, count, offset + total);
+        total += result;
+
+        if (result < bytes)
+            break;
+    }
+
+    return total;
+}
+}
+
+#endif
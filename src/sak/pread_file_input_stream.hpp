@@ -0,0 +1,196 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "sak::pread_file_input_stream requires a POSIX platform"
+#endif
+
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "access_pattern.hpp"
+#include "error.hpp"
+#include "finite_input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// A file input stream for reading local files using the POSIX pread()
+/// function on a raw file descriptor. The stream is only available on
+/// POSIX platforms, sak::file_input_stream is the portable alternative.
+///
+/// The read position is tracked by the stream itself, so seek(),
+/// read_position() and bytes_available() do not require any system
+/// calls. Small reads are served from an internal buffer which is
+/// refilled with a single pread(), reads of at least the buffer size go
+/// directly into the caller's buffer. Reads into a sequence of storage
+/// buffers use preadv() where it is available.
+///
+/// If the file cannot be read, e.g. because it was truncated after it
+/// was opened, the read functions taking a std::error_code report
+/// error::failed_read_file. The other read functions invoke the error
+/// callback if one is set and throw std::system_error otherwise. After
+/// a failed read the read position is unchanged.
+class pread_file_input_stream : public finite_input_stream
+{
+public:
+
+    /// The access pattern hints which can be given to the operating
+    /// system using advise(). The random hint also disables the internal
+    /// buffer of the stream.
+    typedef sak::access_pattern access_pattern;
+
+public:
+
+    /// Constructor
+    /// @param buffer_size the size of the internal buffer in bytes
+    pread_file_input_stream(uint32_t buffer_size = 65536);
+
+    /// Constructor that opens the file immediately
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the filename
+    /// @param buffer_size the size of the internal buffer in bytes
+    pread_file_input_stream(const std::string& filename,
+                            uint32_t buffer_size = 65536);
+
+    /// Destructor, closes the file if it is open
+    ~pread_file_input_stream();
+
+    /// The stream is not copyable
+    pread_file_input_stream(const pread_file_input_stream&) = delete;
+
+    /// The stream is not copyable
+    pread_file_input_stream& operator=(
+        const pread_file_input_stream&) = delete;
+
+    /// Opens the file
+    /// @throws std::system_error Thrown on failure.
+    /// @param filename the file name
+    void open(const std::string& filename);
+
+    /// Opens the file
+    /// @param filename the file name
+    /// @param ec on error set to indicate the type of error, files of
+    ///        4 GiB or more are rejected with error::file_too_large
+    void open(const std::string& filename, std::error_code& ec);
+
+    /// Closes the file
+    void close();
+
+    /// @return true if a file is open
+    bool is_open() const;
+
+    /// Tells the operating system how the file will be accessed. On
+    /// platforms without posix_fadvise() only the effect on the internal
+    /// buffer remains.
+    /// @param pattern the access pattern
+    void advise(access_pattern pattern);
+
+    /// Reads data from the file
+    /// @param buffer the buffer to read into
+    /// @param bytes the number of bytes to read
+    /// @param ec set to error::failed_read_file if the data could not be
+    ///        read, the read position is then unchanged
+    void read(uint8_t* buffer, uint32_t bytes, std::error_code& ec);
+
+    /// Reads data from the file into a sequence of storage buffers
+    /// @param first pointer to the first storage buffer
+    /// @param last pointer to the end of the storage sequence
+    /// @param ec set to error::failed_read_file if the data could not be
+    ///        read, the read position is then unchanged
+    void read(const mutable_storage* first, const mutable_storage* last,
+              std::error_code& ec);
+
+public: // From finite_input_stream
+
+    /// @copydoc finite_input_stream::seek()
+    void seek(uint32_t pos);
+
+    /// @copydoc finite_input_stream::read_position()
+    uint32_t read_position();
+
+    /// @copydoc finite_input_stream::size()
+    uint32_t size();
+
+public: // From input_stream
+
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
+    void read(uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc input_stream::read(const mutable_storage*,
+    ///                             const mutable_storage*)
+    void read(const mutable_storage* first, const mutable_storage* last);
+
+    /// @copydoc input_stream::bytes_available()
+    uint32_t bytes_available();
+
+    /// @copydoc input_stream::peek()
+    /// The data is returned from the internal buffer if max_bytes does
+    /// not exceed its size.
+    const_storage peek(uint32_t max_bytes);
+
+private:
+
+    /// @return true if the internal buffer holds the specified range
+    bool buffered(uint32_t offset, uint32_t bytes) const;
+
+    /// Fills the internal buffer from the specified offset
+    /// @param offset the offset in the file
+    /// @param ec set to error::failed_read_file if the buffer could not
+    ///        be filled, the buffer is then empty
+    void refill(uint32_t offset, std::error_code& ec);
+
+    /// Reports an error to the error callback, or throws it if no
+    /// callback is set
+    /// @param ec the error
+    void report(const std::error_code& ec);
+
+    /// Reads from the file at the specified offset
+    /// @param buffer the buffer to read into
+    /// @param bytes the number of bytes to read
+    /// @param offset the offset in the file
+    /// @return the number of bytes read, less than bytes on failure
+    uint32_t read_at(uint8_t* buffer, uint32_t bytes, uint32_t offset);
+
+    /// Reads from the file at the specified offset into a sequence of
+    /// storage buffers
+    /// @param first pointer to the first storage buffer
+    /// @param last pointer to the end of the storage sequence
+    /// @param offset the offset in the file
+    /// @return the number of bytes read, less than the size of the
+    ///         sequence on failure
+    uint32_t read_at(const mutable_storage* first,
+                     const mutable_storage* last, uint32_t offset);
+
+private:
+
+    /// The file descriptor, -1 if no file is open
+    int m_fd;
+
+    /// The size of the file in bytes
+    uint32_t m_filesize;
+
+    /// The current read position
+    uint32_t m_position;
+
+    /// The internal buffer
+    std::vector<uint8_t> m_buffer;
+
+    /// The offset in the file of the data in the internal buffer
+    uint32_t m_buffer_offset;
+
+    /// The number of valid bytes in the internal buffer
+    uint32_t m_buffered;
+
+    /// True if the internal buffer should not be used
+    bool m_bypass_buffer;
+};
+}
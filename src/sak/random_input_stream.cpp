@@ -5,6 +5,8 @@
 
 #include "random_input_stream.hpp"
 
+#include <algorithm>
+
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -58,4 +60,16 @@ uint32_t random_input_stream::size()
 {
     return static_cast<uint32_t>(m_data.size());
 }
+
+const_storage random_input_stream::peek(uint32_t max_bytes)
+{
+    uint32_t bytes = std::min(max_bytes, bytes_available());
+    return const_storage(m_data.data() + m_current_pos, bytes);
+}
+
+void random_input_stream::consume(uint32_t bytes)
+{
+    assert(bytes <= bytes_available());
+    m_current_pos += bytes;
+}
 }
@@ -39,12 +39,20 @@ public: // From finite_input_stream
 
 public: // From input_stream
 
-    /// @copydoc input_stream::read()
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
     void read(uint8_t* buffer, uint32_t bytes);
 
     /// @copydoc input_stream::bytes_available()
     uint32_t bytes_available();
 
+    /// @copydoc input_stream::peek()
+    const_storage peek(uint32_t max_bytes);
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes);
+
 protected:
 
     /// Pointer to the buffer
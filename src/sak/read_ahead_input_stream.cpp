@@ -0,0 +1,283 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "read_ahead_input_stream.hpp"
+#include "error.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+namespace sak
+{
+read_ahead_input_stream::read_ahead_input_stream(
+    const finite_input_stream::ptr& stream, uint32_t buffers,
+    uint32_t buffer_size) :
+    m_stream(stream),
+    m_size(stream->size()),
+    m_position(stream->read_position()),
+    m_block_offset(0),
+    m_blocks(buffers),
+    m_head(0),
+    m_filled(0),
+    m_fill_position(m_position),
+    m_peek_offset(0),
+    m_generation(0),
+    m_stop(false)
+{
+    assert(m_stream);
+    assert(buffers > 0);
+    assert(buffer_size > 0);
+
+    for (auto& block : m_blocks)
+    {
+        block.m_data.resize(buffer_size);
+        block.m_size = 0;
+    }
+
+    m_thread = std::thread(&read_ahead_input_stream::fill, this);
+}
+
+read_ahead_input_stream::~read_ahead_input_stream()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_block_released.notify_one();
+    m_thread.join();
+}
+
+void read_ahead_input_stream::seek(uint32_t pos)
+{
+    assert(pos <= m_size);
+
+    if (pos == m_position)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_generation;
+        m_filled = 0;
+        m_block_offset = 0;
+        m_fill_position = pos;
+        m_position = pos;
+    }
+    m_block_released.notify_one();
+
+    m_peek_buffer.clear();
+    m_peek_offset = 0;
+}
+
+uint32_t read_ahead_input_stream::read_position()
+{
+    return m_position;
+}
+
+uint32_t read_ahead_input_stream::size()
+{
+    return m_size;
+}
+
+void read_ahead_input_stream::read(uint8_t* buffer, uint32_t bytes)
+{
+    assert(buffer != 0);
+    advance(buffer, bytes);
+}
+
+uint32_t read_ahead_input_stream::bytes_available()
+{
+    return m_size - m_position;
+}
+
+const_storage read_ahead_input_stream::peek(uint32_t max_bytes)
+{
+    uint32_t bytes = std::min(max_bytes, m_size - m_position);
+    uint32_t taken = (uint32_t)m_peek_buffer.size() - m_peek_offset;
+
+    if (bytes == 0)
+        return const_storage();
+
+    // Return the data directly if it is in the first block
+    if (taken == 0)
+    {
+        const block& current = front();
+        if (bytes <= current.m_size - m_block_offset)
+        {
+            return const_storage(
+                current.m_data.data() + m_block_offset, bytes);
+        }
+    }
+
+    // Otherwise take the data out of the blocks, so they are refilled
+    // while the consumer looks at it
+    m_peek_buffer.erase(m_peek_buffer.begin(),
+                        m_peek_buffer.begin() + m_peek_offset);
+    m_peek_offset = 0;
+
+    if (taken < bytes)
+    {
+        m_peek_buffer.resize(bytes);
+
+        try
+        {
+            while (taken < bytes)
+            {
+                taken += take(m_peek_buffer.data() + taken, bytes - taken);
+            }
+        }
+        catch (...)
+        {
+            m_peek_buffer.resize(taken);
+            throw;
+        }
+    }
+
+    return const_storage(m_peek_buffer.data(), bytes);
+}
+
+void read_ahead_input_stream::consume(uint32_t bytes)
+{
+    advance(0, bytes);
+}
+
+void read_ahead_input_stream::advance(uint8_t* buffer, uint32_t bytes)
+{
+    assert(bytes <= m_size - m_position);
+
+    // Start with the data taken out of the blocks by peek()
+    uint32_t taken = std::min<uint32_t>(
+        bytes, m_peek_buffer.size() - m_peek_offset);
+
+    if (buffer != 0)
+    {
+        std::copy_n(m_peek_buffer.data() + m_peek_offset, taken, buffer);
+        buffer += taken;
+    }
+
+    bytes -= taken;
+    m_position += taken;
+    m_peek_offset += taken;
+
+    while (bytes > 0)
+    {
+        uint32_t step = take(buffer, bytes);
+
+        if (buffer != 0)
+        {
+            buffer += step;
+        }
+
+        bytes -= step;
+        m_position += step;
+    }
+}
+
+const read_ahead_input_stream::block& read_ahead_input_stream::front()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_block_filled.wait(lock, [this]()
+    {
+        return m_filled > 0 || m_failure;
+    });
+
+    // The blocks filled before the failure are still delivered
+    if (m_filled == 0)
+        std::rethrow_exception(m_failure);
+
+    return m_blocks[m_head];
+}
+
+uint32_t read_ahead_input_stream::take(uint8_t* buffer, uint32_t bytes)
+{
+    const block& current = front();
+    uint32_t step = std::min(bytes, current.m_size - m_block_offset);
+
+    // The background thread does not touch filled blocks, so the data is
+    // copied without holding the lock
+    if (buffer != 0)
+    {
+        std::copy_n(current.m_data.data() + m_block_offset, step, buffer);
+    }
+
+    m_block_offset += step;
+
+    if (m_block_offset == current.m_size)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_head = (m_head + 1) % m_blocks.size();
+            --m_filled;
+            m_block_offset = 0;
+        }
+        m_block_released.notify_one();
+    }
+
+    return step;
+}
+
+void read_ahead_input_stream::fill()
+{
+    // The position of the wrapped stream, only used by this thread
+    uint32_t stream_position = m_stream->read_position();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_block_released.wait(lock, [this]()
+        {
+            return m_stop ||
+                (m_filled < m_blocks.size() && m_fill_position < m_size);
+        });
+
+        if (m_stop)
+            return;
+
+        uint64_t generation = m_generation;
+        uint32_t position = m_fill_position;
+        block& next = m_blocks[(m_head + m_filled) % m_blocks.size()];
+        uint32_t bytes = std::min<uint32_t>(next.m_data.size(),
+                                            m_size - position);
+
+        lock.unlock();
+
+        try
+        {
+            if (stream_position != position)
+            {
+                m_stream->seek(position);
+            }
+
+            m_stream->read(next.m_data.data(), bytes);
+
+            // Streams reporting errors through the error callback do not
+            // throw, but do not move past the failed read
+            if (m_stream->read_position() != position + bytes)
+                error::throw_error(error::failed_read_file);
+        }
+        catch (...)
+        {
+            // Hand the failure to the consumer and stop reading ahead
+            lock.lock();
+            m_failure = std::current_exception();
+            m_block_filled.notify_one();
+            return;
+        }
+
+        stream_position = position + bytes;
+
+        lock.lock();
+
+        // Discard the block if the consumer has seeked meanwhile
+        if (generation != m_generation)
+            continue;
+
+        next.m_size = bytes;
+        m_fill_position += bytes;
+        ++m_filled;
+        m_block_filled.notify_one();
+    }
+}
+}
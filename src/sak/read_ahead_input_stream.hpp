@@ -0,0 +1,168 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "finite_input_stream.hpp"
+
+namespace sak
+{
+/// Decorator reading ahead of the consumer of a finite_input_stream.
+///
+/// A background thread reads the following blocks of the wrapped stream
+/// into a number of buffers while the consumer processes the data it
+/// has already read, so I/O and computation overlap. Seeking discards
+/// the data read ahead and restarts reading from the new position.
+///
+/// The wrapped stream is used by the background thread and must not be
+/// accessed directly while the decorator exists. If a read of the wrapped
+/// stream fails, the blocks read before it are still delivered, then
+/// read(), peek() and consume() rethrow the exception of the failed read,
+/// or std::system_error with error::failed_read_file if the wrapped
+/// stream reported the error through its error callback. The stream
+/// cannot be read any further after a failure.
+class read_ahead_input_stream : public finite_input_stream
+{
+public:
+
+    /// Constructor, starts reading ahead from the current read position
+    /// of the wrapped stream
+    /// @param stream the stream to read from
+    /// @param buffers the number of buffers to read ahead into
+    /// @param buffer_size the size of each buffer in bytes
+    read_ahead_input_stream(const finite_input_stream::ptr& stream,
+                            uint32_t buffers = 2,
+                            uint32_t buffer_size = 65536);
+
+    /// Destructor, stops the background thread
+    ~read_ahead_input_stream();
+
+    /// The stream is not copyable
+    read_ahead_input_stream(const read_ahead_input_stream&) = delete;
+
+    /// The stream is not copyable
+    read_ahead_input_stream& operator=(
+        const read_ahead_input_stream&) = delete;
+
+public: // From finite_input_stream
+
+    /// @copydoc finite_input_stream::seek()
+    void seek(uint32_t pos);
+
+    /// @copydoc finite_input_stream::read_position()
+    uint32_t read_position();
+
+    /// @copydoc finite_input_stream::size()
+    uint32_t size();
+
+public: // From input_stream
+
+    using input_stream::read;
+
+    /// @copydoc input_stream::read(uint8_t*, uint32_t)
+    void read(uint8_t* buffer, uint32_t bytes);
+
+    /// @copydoc input_stream::bytes_available()
+    uint32_t bytes_available();
+
+    /// @copydoc input_stream::peek()
+    /// Data which is not in the first block is moved out of the blocks,
+    /// so peeking more than the blocks can hold does not stall or restart
+    /// the reads ahead.
+    const_storage peek(uint32_t max_bytes);
+
+    /// @copydoc input_stream::consume()
+    void consume(uint32_t bytes);
+
+private:
+
+    /// Moves the read position forward
+    /// @param buffer if not 0 the data is copied to this buffer
+    /// @param bytes the number of bytes
+    void advance(uint8_t* buffer, uint32_t bytes);
+
+    /// The background thread filling the buffers
+    void fill();
+
+private:
+
+    /// A buffer read ahead
+    struct block
+    {
+        /// The data
+        std::vector<uint8_t> m_data;
+
+        /// The number of bytes in the buffer
+        uint32_t m_size;
+    };
+
+    /// Waits for the first block to be filled
+    /// @return the first filled block
+    /// @throws the failure of the background thread if no block is left
+    const block& front();
+
+    /// Takes data out of the first filled block, releasing it once empty
+    /// @param buffer if not 0 the data is copied to this buffer
+    /// @param bytes the maximum number of bytes
+    /// @return the number of bytes taken
+    uint32_t take(uint8_t* buffer, uint32_t bytes);
+
+    /// The wrapped stream
+    finite_input_stream::ptr m_stream;
+
+    /// The size of the wrapped stream
+    uint32_t m_size;
+
+    /// The read position of the consumer
+    uint32_t m_position;
+
+    /// The read position within the first filled block
+    uint32_t m_block_offset;
+
+    /// The ring of buffers
+    std::vector<block> m_blocks;
+
+    /// Index of the first filled block
+    uint32_t m_head;
+
+    /// The number of filled blocks
+    uint32_t m_filled;
+
+    /// The position in the wrapped stream of the next block to fill
+    uint32_t m_fill_position;
+
+    /// The read position in the data taken out of the blocks by peek(),
+    /// which is held in m_peek_buffer
+    uint32_t m_peek_offset;
+
+    /// Incremented on every seek to discard blocks being filled
+    uint64_t m_generation;
+
+    /// True when the background thread should stop
+    bool m_stop;
+
+    /// The failure of the background thread, if any
+    std::exception_ptr m_failure;
+
+    /// Protects the state shared with the background thread
+    std::mutex m_mutex;
+
+    /// Signals that a block was filled
+    std::condition_variable m_block_filled;
+
+    /// Signals that a block was released or the position changed
+    std::condition_variable m_block_released;
+
+    /// The background thread
+    std::thread m_thread;
+};
+}
@@ -0,0 +1,54 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+
+namespace sak
+{
+/// Handle to a field reserved in a stream, e.g. using
+/// sak::endian_stream::reserve(). The field is written later using the
+/// fill() or fill_length() functions of the stream, which makes it
+/// possible to encode length and checksum fields that come before the
+/// data they describe in a single pass.
+template<class ValueType>
+class reserved_field
+{
+public:
+
+    /// The type of the value stored in the field
+    typedef ValueType value_type;
+
+    /// The size of the field in bytes
+    static const uint32_t size = sizeof(ValueType);
+
+    /// Constructor
+    /// @param position the position of the field in the stream
+    explicit reserved_field(uint32_t position) :
+        m_position(position)
+    { }
+
+    /// @return the position of the field in the stream
+    uint32_t position() const
+    {
+        return m_position;
+    }
+
+    /// @return the position in the stream just after the field
+    uint32_t end() const
+    {
+        return m_position + size;
+    }
+
+private:
+
+    /// The position of the field in the stream
+    uint32_t m_position;
+};
+
+template<class ValueType>
+const uint32_t reserved_field<ValueType>::size;
+}
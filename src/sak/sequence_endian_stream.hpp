@@ -0,0 +1,267 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "storage.hpp"
+#include "convert_endian.hpp"
+
+namespace sak
+{
+/// The sequence_endian_stream provides the interface of the
+/// sak::endian_stream on top of a sequence of storage buffers, e.g.
+/// a header buffer followed by payload chunks from split_storage(). This
+/// makes it possible to serialize directly into scattered buffers and to
+/// parse data that was received in several pieces.
+///
+/// Values which are fully contained in the current buffer are accessed
+/// directly as in the endian_stream. Only values straddling the boundary
+/// between two buffers are copied through a temporary.
+///
+/// Iterators to mutable_storage allow both reading and writing while
+/// iterators to const_storage only allow reading. The storage sequence
+/// must be kept alive as long as the stream is in use.
+template<class StorageIterator>
+class sequence_endian_stream
+{
+public:
+
+    /// The storage type in the sequence
+    typedef typename std::iterator_traits<StorageIterator>::value_type
+        storage_type;
+
+    /// Pointer to the data of the storage type
+    typedef decltype(std::declval<storage_type>().m_data) pointer;
+
+public:
+
+    /// Creates a stream over a sequence of storage buffers
+    /// @param first iterator to the first storage buffer
+    /// @param last iterator to the end of the storage sequence
+    sequence_endian_stream(StorageIterator first, StorageIterator last) :
+        m_first(first),
+        m_last(last),
+        m_size(storage_size(first, last))
+    {
+        seek(0);
+    }
+
+    /// Writes a value of the size of ValueType to the stream
+    /// @param value the value to write
+    template<class ValueType>
+    void write(ValueType value)
+    {
+        // Make sure there is enough space in the storage sequence
+        assert(m_size >= m_position + sizeof(ValueType));
+
+        if (m_segment_remaining >= sizeof(ValueType))
+        {
+            big_endian::put<ValueType>(value, m_data);
+            advance(sizeof(ValueType));
+        }
+        else
+        {
+            uint8_t temp[sizeof(ValueType)];
+            big_endian::put<ValueType>(value, temp);
+            copy_in(temp, sizeof(ValueType));
+        }
+    }
+
+    /// Writes the contents of a sak::storage container to the stream.
+    /// Note that this function does not perform any endian conversions
+    /// and that the length of the container is not written to the stream.
+    /// @param storage the storage to write
+    void write(const mutable_storage& storage)
+    {
+        write(const_storage(storage));
+    }
+
+    /// @copydoc write(const mutable_storage&)
+    void write(const const_storage& storage)
+    {
+        // Make sure there is enough space in the storage sequence
+        assert(m_size >= m_position + storage.m_size);
+        copy_in(storage.m_data, storage.m_size);
+    }
+
+    /// Reads from the stream and moves the read position.
+    /// @param value reference to the value to be read
+    template<class ValueType>
+    void read(ValueType& value)
+    {
+        // Make sure there is enough data to read in the storage sequence
+        assert(m_size >= m_position + sizeof(ValueType));
+
+        if (m_segment_remaining >= sizeof(ValueType))
+        {
+            value = big_endian::get<ValueType>(m_data);
+            advance(sizeof(ValueType));
+        }
+        else
+        {
+            uint8_t temp[sizeof(ValueType)];
+            copy_out(temp, sizeof(ValueType));
+            value = big_endian::get<ValueType>(temp);
+        }
+    }
+
+    /// Reads data from the stream to fill a mutable storage. Note that
+    /// this function does not perform any endian conversions.
+    /// @param storage the storage to be filled
+    void read(const mutable_storage& storage)
+    {
+        // Make sure there is enough data to read in the storage sequence
+        assert(m_size >= m_position + storage.m_size);
+        copy_out(storage.m_data, storage.m_size);
+    }
+
+    /// @return the total size of the storage sequence
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /// @return the current read/write position in the stream
+    uint32_t position() const
+    {
+        return m_position;
+    }
+
+    /// @return the number of bytes between the current position and the
+    ///         end of the stream
+    uint32_t remaining_size() const
+    {
+        return m_size - m_position;
+    }
+
+    /// Changes the current read/write position in the stream. The
+    /// position is found by walking the storage sequence from the start.
+    /// @param new_position the new position
+    void seek(uint32_t new_position)
+    {
+        assert(new_position <= m_size);
+
+        m_current = m_first;
+        m_position = 0;
+        m_data = 0;
+        m_segment_remaining = 0;
+
+        skip_to_segment(new_position);
+    }
+
+private:
+
+    /// Moves the position forward within the current segment
+    void advance(uint32_t bytes)
+    {
+        assert(bytes <= m_segment_remaining);
+        m_data += bytes;
+        m_segment_remaining -= bytes;
+        m_position += bytes;
+    }
+
+    /// Moves to the next non-empty segment if the current one is
+    /// exhausted
+    void next_segment()
+    {
+        while (m_segment_remaining == 0 && m_current != m_last)
+        {
+            m_data = m_current->m_data;
+            m_segment_remaining = m_current->m_size;
+            ++m_current;
+        }
+    }
+
+    /// Moves the position forward from the current segment
+    /// @param bytes the number of bytes to move
+    void skip_to_segment(uint32_t bytes)
+    {
+        while (true)
+        {
+            next_segment();
+
+            uint32_t step = std::min(bytes, m_segment_remaining);
+            advance(step);
+            bytes -= step;
+
+            if (bytes == 0)
+                return;
+        }
+    }
+
+    /// Copies data into the stream across segment boundaries
+    void copy_in(const uint8_t* data, uint32_t bytes)
+    {
+        while (bytes > 0)
+        {
+            next_segment();
+
+            uint32_t step = std::min(bytes, m_segment_remaining);
+            std::copy_n(data, step, m_data);
+            advance(step);
+
+            data += step;
+            bytes -= step;
+        }
+    }
+
+    /// Copies data out of the stream across segment boundaries
+    void copy_out(uint8_t* data, uint32_t bytes)
+    {
+        while (bytes > 0)
+        {
+            next_segment();
+
+            uint32_t step = std::min(bytes, m_segment_remaining);
+            std::copy_n(m_data, step, data);
+            advance(step);
+
+            data += step;
+            bytes -= step;
+        }
+    }
+
+private:
+
+    /// Iterator to the first storage buffer
+    StorageIterator m_first;
+
+    /// Iterator to the end of the storage sequence
+    StorageIterator m_last;
+
+    /// Iterator to the storage buffer after the current one
+    StorageIterator m_current;
+
+    /// Pointer to the current position in the current storage buffer
+    pointer m_data;
+
+    /// The number of bytes left in the current storage buffer
+    uint32_t m_segment_remaining;
+
+    /// The total size of the storage sequence
+    uint32_t m_size;
+
+    /// The current position in the stream
+    uint32_t m_position;
+};
+
+/// Creates a sequence_endian_stream over a storage sequence
+/// @param first iterator to the first storage buffer
+/// @param last iterator to the end of the storage sequence
+/// @return the stream
+template<class StorageIterator>
+inline sequence_endian_stream<StorageIterator>
+make_sequence_endian_stream(StorageIterator first, StorageIterator last)
+{
+    return sequence_endian_stream<StorageIterator>(first, last);
+}
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include "symbol_chunker.hpp"
+
+#include <cassert>
+#include <algorithm>
+
+#include "ceil_division.hpp"
+
+namespace sak
+{
+symbol_chunker::symbol_chunker(const finite_input_stream::ptr& stream,
+                               uint32_t symbol_size,
+                               uint32_t generation_size,
+                               uint32_t buffers) :
+    m_stream(stream),
+    m_start(0),
+    m_size(0),
+    m_symbol_size(symbol_size),
+    m_generation_size(generation_size),
+    m_symbols(0),
+    m_generations(0),
+    m_generation(0),
+    m_next_buffer(0)
+{
+    assert(m_stream);
+    assert(m_symbol_size > 0);
+    assert(m_generation_size > 0);
+    assert(buffers > 0);
+
+    m_start = m_stream->read_position();
+    m_size = m_stream->bytes_available();
+    m_symbols = ceil_division(m_size, m_symbol_size);
+    m_generations = ceil_division(m_symbols, m_generation_size);
+
+    // No buffer needs to be larger than the padded stream
+    uint32_t symbols = std::min(m_symbols, m_generation_size);
+    assert(symbols <= 0xFFFFFFFFU / m_symbol_size);
+
+    m_buffers.resize(std::min(buffers, m_generations),
+                     std::vector<uint8_t>(symbols * m_symbol_size));
+}
+
+mutable_storage symbol_chunker::next()
+{
+    std::error_code ec;
+    mutable_storage symbols = next(ec);
+    error::throw_error(ec);
+    return symbols;
+}
+
+mutable_storage symbol_chunker::next(std::error_code& ec)
+{
+    assert(!finished());
+
+    std::vector<uint8_t>& buffer = m_buffers[m_next_buffer];
+    m_next_buffer = (m_next_buffer + 1) % m_buffers.size();
+
+    // The offset is below m_size, so the products cannot overflow
+    uint32_t first_symbol = m_generation * m_generation_size;
+    uint32_t offset = first_symbol * m_symbol_size;
+    uint32_t padded = symbols(m_generation) * m_symbol_size;
+    uint32_t bytes = std::min(m_size - offset, padded);
+
+    uint32_t position = m_stream->read_position();
+    m_stream->read(buffer.data(), bytes);
+
+    // Streams reporting errors through the error callback do not move
+    // past the failed read
+    if (m_stream->read_position() != position + bytes)
+    {
+        m_stream->seek(position);
+        ec = error::failed_read_file;
+        return mutable_storage();
+    }
+
+    // Only the last symbol of the stream can be partial
+    std::fill(buffer.data() + bytes, buffer.data() + padded, 0);
+
+    ++m_generation;
+    return mutable_storage(buffer.data(), padded);
+}
+
+bool symbol_chunker::finished() const
+{
+    return m_generation == m_generations;
+}
+
+void symbol_chunker::reset()
+{
+    m_stream->seek(m_start);
+    m_generation = 0;
+}
+
+uint32_t symbol_chunker::generation() const
+{
+    return m_generation;
+}
+
+uint32_t symbol_chunker::symbols(uint32_t generation) const
+{
+    assert(generation < m_generations);
+
+    uint32_t first_symbol = generation * m_generation_size;
+    return std::min(m_generation_size, m_symbols - first_symbol);
+}
+
+uint32_t symbol_chunker::symbols() const
+{
+    return m_symbols;
+}
+
+uint32_t symbol_chunker::generations() const
+{
+    return m_generations;
+}
+
+uint32_t symbol_chunker::symbol_size() const
+{
+    return m_symbol_size;
+}
+
+uint32_t symbol_chunker::generation_size() const
+{
+    return m_generation_size;
+}
+
+uint32_t symbol_chunker::size() const
+{
+    return m_size;
+}
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#pragma once
+
+#include <cstdint>
+#include <system_error>
+#include <vector>
+
+#include "error.hpp"
+#include "finite_input_stream.hpp"
+#include "storage.hpp"
+
+namespace sak
+{
+/// Cuts a finite stream into symbols of a fixed size which are grouped
+/// into generations. The stream contains ceil_division(size, symbol_size)
+/// symbols where the last symbol is padded with zeros, and every
+/// generation except the last contains generation_size symbols.
+///
+/// Each call to next() reads one generation directly into one of a
+/// number of recycled buffers and returns the symbols as a single
+/// mutable_storage, which can be split using sak::split_storage(). Only
+/// the padding of the last symbol is written in addition to the data
+/// read from the stream.
+///
+/// Example:
+///
+///     sak::symbol_chunker chunker(stream, 1400, 64);
+///
+///     while (!chunker.finished())
+///     {
+///         auto symbols = sak::split_storage(chunker.next(), 1400);
+///         encode(symbols);
+///     }
+///
+class symbol_chunker
+{
+public:
+
+    /// Constructor, the symbols are read from the current read position
+    /// of the stream
+    /// @param stream the stream to read from
+    /// @param symbol_size the size of a symbol in bytes
+    /// @param generation_size the number of symbols in a generation
+    /// @param buffers the number of buffers to recycle, a generation
+    ///        returned by next() stays valid until next() has been called
+    ///        this number of times
+    symbol_chunker(const finite_input_stream::ptr& stream,
+                   uint32_t symbol_size, uint32_t generation_size = 1,
+                   uint32_t buffers = 1);
+
+    /// Reads the next generation from the stream
+    /// @param ec set to error::failed_read_file if the stream did not
+    ///        provide the data of the generation, the generation can then
+    ///        be read again
+    /// @return the symbols of the generation, empty on error
+    mutable_storage next(std::error_code& ec);
+
+    /// Reads the next generation from the stream
+    /// @return the symbols of the generation
+    /// @throws std::system_error if the data cannot be read
+    mutable_storage next();
+
+    /// @return true if all generations have been read
+    bool finished() const;
+
+    /// Moves the stream back to its initial read position, so the
+    /// generations can be read again
+    void reset();
+
+    /// @return the index of the generation returned by the next call to
+    ///         next()
+    uint32_t generation() const;
+
+    /// @param generation the index of a generation
+    /// @return the number of symbols in the generation
+    uint32_t symbols(uint32_t generation) const;
+
+    /// @return the number of symbols in the stream
+    uint32_t symbols() const;
+
+    /// @return the number of generations in the stream
+    uint32_t generations() const;
+
+    /// @return the size of a symbol in bytes
+    uint32_t symbol_size() const;
+
+    /// @return the number of symbols in a full generation
+    uint32_t generation_size() const;
+
+    /// @return the number of bytes read from the stream, excluding the
+    ///         padding
+    uint32_t size() const;
+
+private:
+
+    /// The stream to read from
+    finite_input_stream::ptr m_stream;
+
+    /// The initial read position of the stream
+    uint32_t m_start;
+
+    /// The number of bytes to read from the stream
+    uint32_t m_size;
+
+    /// The size of a symbol
+    uint32_t m_symbol_size;
+
+    /// The number of symbols in a full generation
+    uint32_t m_generation_size;
+
+    /// The number of symbols
+    uint32_t m_symbols;
+
+    /// The number of generations
+    uint32_t m_generations;
+
+    /// The index of the next generation
+    uint32_t m_generation;
+
+    /// The recycled buffers
+    std::vector<std::vector<uint8_t>> m_buffers;
+
+    /// The index of the next buffer to use
+    uint32_t m_next_buffer;
+};
+}
@@ -0,0 +1,267 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sak/async_file_input_stream.hpp>
+#include <sak/async_read_backend.hpp>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+namespace
+{
+std::vector<uint8_t> write_random_file(const std::string& file_name,
+                                       uint32_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (auto& v : data)
+    {
+        v = rand() % 255;
+    }
+
+    std::ofstream file(file_name.c_str(), std::ios::out | std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return data;
+}
+
+/// A backend accepting the reads, but failing when waited for
+struct failing_backend : public sak::detail::async_read_backend
+{
+    void submit(const sak::detail::read_request& request) override
+    {
+        m_requests.push_back(request);
+    }
+
+    int wait(std::vector<sak::detail::read_completion>&, bool) override
+    {
+        return -EIO;
+    }
+
+    std::vector<sak::detail::read_request> m_requests;
+};
+
+void read_file(sak::async_file_input_stream::backend_type backend)
+{
+    std::string file_name("test_async.bin");
+    std::vector<uint8_t> data = write_random_file(file_name, 100000);
+
+    sak::async_file_input_stream stream(4, 4096, backend);
+
+    if (backend == sak::async_file_input_stream::backend_type::thread_pool)
+    {
+        EXPECT_EQ(backend, stream.backend());
+    }
+
+    stream.open(file_name);
+    EXPECT_EQ(data.size(), stream.size());
+
+    std::vector<uint8_t> result;
+    uint32_t ready_reads = 0;
+    uint32_t stops = 0;
+
+    stream.on_ready_read([&]()
+    {
+        ++ready_reads;
+
+        // Read the available data in two parts to cross buffers
+        uint32_t bytes = stream.bytes_available();
+        ASSERT_GT(bytes, 0U);
+
+        std::vector<uint8_t> chunk(bytes);
+        stream.read(chunk.data(), bytes / 2);
+        stream.read(chunk.data() + bytes / 2, bytes - bytes / 2);
+        result.insert(result.end(), chunk.begin(), chunk.end());
+    });
+
+    stream.on_stopped([&]()
+    {
+        ++stops;
+    });
+
+    stream.on_error([](const std::string& message)
+    {
+        ADD_FAILURE() << message;
+    });
+
+    stream.run();
+
+    EXPECT_TRUE(stream.stopped());
+    EXPECT_EQ(1U, stops);
+    EXPECT_GT(ready_reads, 0U);
+    EXPECT_EQ(0U, stream.bytes_available());
+    EXPECT_EQ(data, result);
+
+    stream.close();
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+}
+
+/// Tests reading a file with io_uring, or the fallback if io_uring is
+/// not available
+TEST(TestAsyncFileInputStream, ReadIoUring)
+{
+    read_file(sak::async_file_input_stream::backend_type::io_uring);
+}
+
+/// Tests reading a file with the thread pool
+TEST(TestAsyncFileInputStream, ReadThreadPool)
+{
+    read_file(sak::async_file_input_stream::backend_type::thread_pool);
+}
+
+/// Tests that the reads stop when the consumer does not read the data
+/// and continue when it does
+TEST(TestAsyncFileInputStream, PollWithoutConsuming)
+{
+    std::string file_name("test_async_poll.bin");
+    std::vector<uint8_t> data = write_random_file(file_name, 1000);
+
+    sak::async_file_input_stream stream(2, 100);
+    stream.open(file_name);
+
+    // Only the two buffers can be filled
+    stream.run();
+    EXPECT_FALSE(stream.stopped());
+    EXPECT_EQ(200U, stream.bytes_available());
+
+    std::vector<uint8_t> result(data.size());
+    uint32_t position = 0;
+
+    while (!stream.stopped() || stream.bytes_available() > 0)
+    {
+        uint32_t bytes = stream.bytes_available();
+        stream.read(result.data() + position, bytes);
+        position += bytes;
+
+        stream.poll();
+        stream.run();
+    }
+
+    EXPECT_EQ(data, result);
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests peeking at data spread over several buffers
+TEST(TestAsyncFileInputStream, PeekAndConsume)
+{
+    std::string file_name("test_async_peek.bin");
+    std::vector<uint8_t> data = write_random_file(file_name, 1000);
+
+    sak::async_file_input_stream stream(4, 100);
+    stream.open(file_name);
+    stream.run();
+    ASSERT_EQ(400U, stream.bytes_available());
+
+    // Within a single buffer
+    sak::const_storage view = stream.peek(50);
+    ASSERT_EQ(50U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 50, data.begin()));
+
+    // Across buffers
+    stream.consume(80);
+    view = stream.peek(150);
+    ASSERT_EQ(150U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 150,
+                           data.begin() + 80));
+    EXPECT_EQ(320U, stream.bytes_available());
+
+    // Limited to the available data
+    stream.consume(300);
+    EXPECT_EQ(20U, stream.peek(100).m_size);
+
+    stream.run();
+    view = stream.peek(100);
+    ASSERT_EQ(100U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 100,
+                           data.begin() + 380));
+
+    stream.close();
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests error handling with error code
+TEST(TestAsyncFileInputStream, ReturnErrorCode)
+{
+    sak::async_file_input_stream stream;
+
+    std::error_code ec;
+    stream.open("strange_file_that_should_not_exist.notfound", ec);
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+    EXPECT_FALSE(stream.is_open());
+}
+
+/// Tests that files which do not fit in 32 bits are rejected
+TEST(TestAsyncFileInputStream, FileTooLarge)
+{
+    std::string file_name("test_async_too_large.bin");
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+    }
+
+    // Create a sparse file of 4 GiB
+    ASSERT_EQ(0, ::truncate(file_name.c_str(), 0x100000000LL));
+
+    sak::async_file_input_stream stream;
+
+    std::error_code ec;
+    stream.open(file_name, ec);
+    EXPECT_EQ(sak::error::file_too_large, ec);
+    EXPECT_FALSE(stream.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that a failure of the backend is reported to the pending reads
+/// instead of waiting for them forever
+TEST(TestAsyncFileInputStream, BackendFailure)
+{
+    std::string file_name("test_async_failure.bin");
+    write_random_file(file_name, 1000);
+
+    auto backend = new failing_backend();
+    sak::async_file_input_stream stream(
+        std::unique_ptr<sak::detail::async_read_backend>(backend), 4, 100);
+    EXPECT_EQ(sak::async_file_input_stream::backend_type::custom,
+              stream.backend());
+
+    stream.open(file_name);
+    EXPECT_EQ(4U, backend->m_requests.size());
+
+    uint32_t errors = 0;
+    stream.on_error([&](const std::string& message)
+    {
+        EXPECT_FALSE(message.empty());
+        ++errors;
+    });
+
+    stream.on_ready_read([]()
+    {
+        ADD_FAILURE() << "No data should be ready";
+    });
+
+    stream.run();
+
+    EXPECT_EQ(1U, errors);
+    EXPECT_TRUE(stream.stopped());
+    EXPECT_EQ(0U, stream.bytes_available());
+
+    stream.close();
+    EXPECT_FALSE(stream.is_open());
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+#endif
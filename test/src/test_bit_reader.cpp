@@ -0,0 +1,96 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/bit_reader.hpp>
+#include <sak/bit_writer.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestBitReader, read_fields)
+{
+    std::vector<uint8_t> buffer = { 0xDA, 0xBC, 0x30 };
+    sak::bit_reader reader(sak::storage(buffer));
+
+    EXPECT_EQ(3U, reader.size());
+    EXPECT_EQ(24U, reader.bits_available());
+
+    EXPECT_EQ(1U, reader.read(1));
+    EXPECT_EQ(5U, reader.read(3));
+
+    uint16_t length = 0;
+    reader.read(length, 12);
+    EXPECT_EQ(0xABCU, length);
+
+    EXPECT_EQ(16U, reader.bits_read());
+    EXPECT_EQ(0x3U, reader.read(4));
+
+    reader.align();
+    EXPECT_EQ(24U, reader.bits_read());
+    EXPECT_EQ(0U, reader.bits_available());
+}
+
+TEST(TestBitReader, skip)
+{
+    std::vector<uint8_t> buffer = { 0x0F, 0xF0 };
+    sak::bit_reader reader(buffer.data(), (uint32_t)buffer.size());
+
+    reader.skip(4);
+    EXPECT_EQ(0xFFU, reader.read(8));
+    EXPECT_EQ(4U, reader.bits_available());
+}
+
+TEST(TestBitReader, write_read_random)
+{
+    const uint32_t count = 1000;
+
+    std::vector<uint64_t> values(count);
+    std::vector<uint32_t> bits(count);
+
+    uint64_t total_bits = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        bits[i] = (rand() % 64) + 1;
+        uint64_t value = (uint64_t(rand()) << 40) ^
+                         (uint64_t(rand()) << 20) ^ uint64_t(rand());
+        values[i] = bits[i] == 64 ? value : value & ((1ULL << bits[i]) - 1);
+        total_bits += bits[i];
+    }
+
+    std::vector<uint8_t> buffer((uint32_t)((total_bits + 7) / 8));
+    sak::bit_writer writer(sak::storage(buffer));
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        writer.write(values[i], bits[i]);
+    }
+    writer.flush();
+    EXPECT_EQ(buffer.size(), writer.bytes_written());
+
+    sak::bit_reader reader(sak::storage(buffer));
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(values[i], reader.read(bits[i]));
+    }
+    EXPECT_EQ(total_bits, reader.bits_read());
+}
+
+TEST(TestBitReader, read_array)
+{
+    std::vector<uint8_t> values = { 1, 7, 0, 5, 3, 6, 2 };
+
+    std::vector<uint8_t> buffer(3);
+    sak::bit_writer writer(sak::storage(buffer));
+    writer.write_array(values.data(), (uint32_t)values.size(), 3);
+    writer.flush();
+
+    std::vector<uint8_t> decoded(values.size());
+    sak::bit_reader reader(sak::storage(buffer));
+    reader.read_array(decoded.data(), (uint32_t)decoded.size(), 3);
+
+    EXPECT_EQ(values, decoded);
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/bit_writer.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestBitWriter, create)
+{
+    std::vector<uint8_t> buffer(16);
+    sak::bit_writer writer(sak::storage(buffer));
+
+    EXPECT_EQ(16U, writer.size());
+    EXPECT_EQ(0U, writer.bits_written());
+    EXPECT_EQ(0U, writer.bytes_written());
+}
+
+TEST(TestBitWriter, write_fields)
+{
+    std::vector<uint8_t> buffer(4, 0xFF);
+    sak::bit_writer writer(buffer.data(), (uint32_t)buffer.size());
+
+    // 1-bit flag, 3-bit type and 12-bit length
+    writer.write(1, 1);
+    writer.write(5, 3);
+    writer.write(0xABC, 12);
+    EXPECT_EQ(16U, writer.bits_written());
+
+    // Nothing is written before the flush
+    EXPECT_EQ(0U, writer.bytes_written());
+
+    // A 4-bit field padded to a byte boundary
+    writer.write(0x3, 4);
+    writer.flush();
+    EXPECT_EQ(3U, writer.bytes_written());
+    EXPECT_EQ(24U, writer.bits_written());
+
+    EXPECT_EQ(0xDAU, buffer[0]);
+    EXPECT_EQ(0xBCU, buffer[1]);
+    EXPECT_EQ(0x30U, buffer[2]);
+    EXPECT_EQ(0xFFU, buffer[3]);
+}
+
+TEST(TestBitWriter, write_words)
+{
+    std::vector<uint8_t> buffer(24);
+    sak::bit_writer writer(sak::storage(buffer));
+
+    // Fields crossing the word boundaries
+    writer.write(0x7F, 7);
+    writer.write(0x0123456789ABCDEFULL, 64);
+    writer.write(0, 57);
+    writer.write(0xFFFFFFFFFFFFFFFFULL, 64);
+    EXPECT_EQ(192U, writer.bits_written());
+    EXPECT_EQ(24U, writer.bytes_written());
+
+    writer.flush();
+    EXPECT_EQ(24U, writer.bytes_written());
+
+    EXPECT_EQ(0xFEU, buffer[0]);
+    EXPECT_EQ(0x02U, buffer[1]);
+    EXPECT_EQ(0x46U, buffer[2]);
+    EXPECT_EQ(0xDEU, buffer[8]);
+    EXPECT_EQ(0x00U, buffer[15]);
+    EXPECT_EQ(0xFFU, buffer[16]);
+    EXPECT_EQ(0xFFU, buffer[23]);
+}
+
+TEST(TestBitWriter, write_array)
+{
+    std::vector<uint8_t> buffer(3);
+    sak::bit_writer writer(sak::storage(buffer));
+
+    std::vector<uint16_t> values = { 0x001, 0x002 };
+    writer.write_array(values.data(), (uint32_t)values.size(), 12);
+    writer.flush();
+
+    EXPECT_EQ(3U, writer.bytes_written());
+    EXPECT_EQ(0x00U, buffer[0]);
+    EXPECT_EQ(0x10U, buffer[1]);
+    EXPECT_EQ(0x02U, buffer[2]);
+}
@@ -116,3 +116,63 @@ TEST(TestBufferInputStream, CreateBufferInputStream)
         ASSERT_TRUE(input_stream_2.stopped() == true);
     }
 }
+
+/// Tests reading into a sequence of storage buffers
+TEST(TestBufferInputStream, ReadSequence)
+{
+    std::vector<uint8_t> data(100);
+    for (uint32_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    sak::buffer_input_stream stream(sak::storage(data));
+
+    std::vector<uint8_t> header(4);
+    std::vector<uint8_t> first(10);
+    std::vector<uint8_t> second(20);
+
+    std::vector<sak::mutable_storage> sequence;
+    sequence.push_back(sak::storage(header));
+    sequence.push_back(sak::storage(first));
+    sequence.push_back(sak::storage(second));
+
+    stream.seek(5);
+    stream.read(sequence.data(), sequence.data() + sequence.size());
+
+    EXPECT_EQ(39U, stream.read_position());
+    EXPECT_TRUE(std::equal(header.begin(), header.end(), data.begin() + 5));
+    EXPECT_TRUE(std::equal(first.begin(), first.end(), data.begin() + 9));
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), data.begin() + 19));
+
+    // The default implementation gives the same result
+    stream.seek(5);
+    std::fill(second.begin(), second.end(), 0);
+    stream.input_stream::read(sequence.data(),
+                              sequence.data() + sequence.size());
+    EXPECT_TRUE(std::equal(second.begin(), second.end(), data.begin() + 19));
+}
+
+/// Tests that peek() returns the data without copying it
+TEST(TestBufferInputStream, PeekAndConsume)
+{
+    std::vector<uint8_t> data = {1, 2, 3, 4, 5};
+    sak::buffer_input_stream stream(sak::storage(data));
+
+    sak::const_storage view = stream.peek(3);
+    EXPECT_EQ(data.data(), view.m_data);
+    EXPECT_EQ(3U, view.m_size);
+    EXPECT_EQ(0U, stream.read_position());
+
+    stream.consume(2);
+    view = stream.peek(10);
+    EXPECT_EQ(data.data() + 2, view.m_data);
+    EXPECT_EQ(3U, view.m_size);
+
+    uint8_t value = 0;
+    stream.read(&value, 1);
+    EXPECT_EQ(3U, value);
+
+    stream.consume(2);
+    EXPECT_EQ(0U, stream.peek(10).m_size);
+}
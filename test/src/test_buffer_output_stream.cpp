@@ -0,0 +1,52 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/buffer_output_stream.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+/// Tests that writes are appended to the buffer
+TEST(TestBufferOutputStream, Write)
+{
+    sak::buffer buffer;
+    buffer.append(std::vector<uint8_t>{1, 2}.data(), 2);
+
+    sak::buffer_output_stream stream(buffer);
+    sak::output_stream& output = stream;
+
+    std::vector<uint8_t> data = {3, 4, 5};
+    output.write(data.data(), (uint32_t) data.size());
+    output.flush();
+
+    std::vector<uint8_t> expected = {1, 2, 3, 4, 5};
+    ASSERT_EQ(expected.size(), buffer.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.data()));
+}
+
+/// Tests writing a storage sequence
+TEST(TestBufferOutputStream, WriteSequence)
+{
+    sak::buffer buffer;
+    sak::buffer_output_stream stream(buffer);
+    sak::output_stream& output = stream;
+
+    std::vector<uint8_t> header = {0xAA, 0xBB};
+    std::vector<uint8_t> payload = {1, 2, 3, 4};
+
+    std::vector<sak::const_storage> sequence;
+    sequence.push_back(sak::storage(header));
+    sequence.push_back(sak::const_storage());
+    sequence.push_back(sak::storage(payload));
+
+    output.write(sequence.data(), sequence.data() + sequence.size());
+    output.write(sequence.data(), sequence.data());
+
+    std::vector<uint8_t> expected = {0xAA, 0xBB, 1, 2, 3, 4};
+    ASSERT_EQ(expected.size(), buffer.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), buffer.data()));
+}
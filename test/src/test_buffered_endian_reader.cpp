@@ -0,0 +1,242 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/buffered_endian_reader.hpp>
+#include <sak/buffer_input_stream.hpp>
+#include <sak/endian_stream.hpp>
+
+#include <numeric>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestBufferedEndianReader, read_values)
+{
+    const uint32_t elements = 1000;
+    std::vector<uint8_t> buffer(elements * 16);
+    sak::endian_stream writer(sak::storage(buffer));
+
+    for (uint32_t i = 0; i < elements; ++i)
+    {
+        writer.write<uint8_t>(i % 256);
+        writer.write<uint32_t>(i);
+        writer.write<3>(i);
+        writer.write<uint64_t>(i * 3ULL);
+    }
+    uint32_t size = writer.position();
+
+    sak::buffer_input_stream input(sak::const_storage(buffer.data(), size));
+
+    // Use a small window which is not a multiple of the record size so
+    // values cross the refill boundaries
+    sak::buffered_endian_reader reader(input, 37);
+    EXPECT_EQ(37U, reader.window_size());
+    EXPECT_EQ(size, reader.bytes_available());
+
+    for (uint32_t i = 0; i < elements; ++i)
+    {
+        uint8_t u8 = 0;
+        uint32_t u32 = 0;
+        uint32_t u24 = 0;
+        uint64_t u64 = 0;
+        reader.read(u8);
+        reader.read(u32);
+        reader.read<3>(u24);
+        reader.read(u64);
+
+        ASSERT_EQ(i % 256, u8);
+        ASSERT_EQ(i, u32);
+        ASSERT_EQ(i, u24);
+        ASSERT_EQ(i * 3ULL, u64);
+    }
+
+    EXPECT_EQ(size, reader.position());
+    EXPECT_EQ(0U, reader.bytes_available());
+}
+
+TEST(TestBufferedEndianReader, read_storage_and_views)
+{
+    std::vector<uint8_t> buffer(1000);
+    for (uint32_t i = 0; i < buffer.size(); ++i)
+    {
+        buffer[i] = i % 251;
+    }
+
+    sak::buffer_input_stream input(sak::storage(buffer));
+    sak::buffered_endian_reader reader(input, 64);
+
+    // A small read through the window
+    std::vector<uint8_t> small(10);
+    reader.read(sak::storage(small));
+    EXPECT_TRUE(std::equal(small.begin(), small.end(), buffer.begin()));
+
+    // A large read bypassing the window
+    std::vector<uint8_t> large(500);
+    reader.read(sak::storage(large));
+    EXPECT_TRUE(std::equal(large.begin(), large.end(), buffer.begin() + 10));
+    EXPECT_EQ(510U, reader.position());
+
+    sak::const_storage view = reader.read_view(64);
+    EXPECT_TRUE(sak::is_equal(view, sak::const_storage(&buffer[510], 64)));
+
+    reader.skip(100);
+    EXPECT_EQ(674U, reader.position());
+
+    uint16_t values[3];
+    reader.read_array(values, 3);
+    EXPECT_EQ(sak::big_endian::get16(&buffer[674]), values[0]);
+    EXPECT_EQ(sak::big_endian::get16(&buffer[678]), values[2]);
+    EXPECT_EQ(1000U - 680U, reader.bytes_available());
+}
+
+TEST(TestBufferedEndianReader, read_varint)
+{
+    std::vector<uint8_t> buffer(1000);
+    sak::endian_stream writer(sak::storage(buffer));
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        writer.write_varint(i << (i % 57));
+    }
+    uint32_t size = writer.position();
+
+    sak::buffer_input_stream input(sak::const_storage(buffer.data(), size));
+    sak::buffered_endian_reader reader(input, 16);
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        uint64_t value = 0;
+        reader.read_varint(value);
+        EXPECT_EQ(i << (i % 57), value);
+    }
+    EXPECT_EQ(size, reader.position());
+}
+
+namespace
+{
+// Counts the calls to bytes_available(), i.e. the refills of the reader
+class counting_input_stream : public sak::buffer_input_stream
+{
+public:
+
+    counting_input_stream(const sak::const_storage& storage) :
+        sak::buffer_input_stream(storage),
+        m_calls(0)
+    { }
+
+    uint32_t bytes_available()
+    {
+        ++m_calls;
+        return sak::buffer_input_stream::bytes_available();
+    }
+
+    uint32_t m_calls;
+};
+}
+
+TEST(TestBufferedEndianReader, read_varint_refills)
+{
+    std::vector<uint8_t> buffer(100);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    counting_input_stream input(sak::storage(buffer));
+    sak::buffered_endian_reader reader(input, 1000);
+
+    // The single byte values at the end of the stream are decoded from
+    // the window without refilling it
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        uint8_t value = 0;
+        reader.read_varint(value);
+        EXPECT_EQ(i, value);
+    }
+    EXPECT_EQ(1U, input.m_calls);
+}
+
+TEST(TestBufferedEndianReader, read_with_error_code)
+{
+    std::vector<uint8_t> buffer(7);
+    sak::endian_stream writer(sak::storage(buffer));
+    writer.write<uint32_t>(0x01020304U);
+    writer.write<uint16_t>(0x0506U);
+    writer.write<uint8_t>(0x80U);
+
+    sak::buffer_input_stream input(sak::storage(buffer));
+    sak::buffered_endian_reader reader(input, 16);
+
+    std::error_code ec;
+    uint32_t u32 = 0;
+    reader.read(u32, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(0x01020304U, u32);
+
+    // Only three bytes remain
+    reader.read(u32, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+
+    // The error is sticky
+    ec.clear();
+    uint8_t u8 = 0;
+    reader.read(u8, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+
+    ec.clear();
+    EXPECT_EQ(0U, reader.read_view(1, ec).m_size);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+}
+
+TEST(TestBufferedEndianReader, read_varint_with_error_code)
+{
+    std::vector<uint8_t> buffer = {0xAC, 0x02, 0xFF, 0x03, 0x80};
+
+    sak::buffer_input_stream input(sak::storage(buffer));
+    sak::buffered_endian_reader reader(input, 16);
+
+    std::error_code ec;
+    uint16_t value = 0;
+    reader.read_varint(value, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(300U, value);
+
+    // 511 does not fit in a uint8_t
+    uint8_t small = 0;
+    reader.read_varint(small, ec);
+    EXPECT_EQ(sak::error::invalid_varint, ec);
+
+    // The following value would have been truncated anyway
+    ec.clear();
+    reader.read_varint(value, ec);
+    EXPECT_EQ(sak::error::invalid_varint, ec);
+}
+
+TEST(TestBufferedEndianReader, read_storage_with_error_code)
+{
+    std::vector<uint8_t> buffer(100, 7);
+
+    sak::buffer_input_stream input(sak::storage(buffer));
+    sak::buffered_endian_reader reader(input, 16);
+
+    std::error_code ec;
+    std::vector<uint8_t> data(60);
+    reader.read(sak::storage(data), ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(std::vector<uint8_t>(60, 7), data);
+
+    reader.skip(30, ec);
+    EXPECT_FALSE(ec);
+
+    std::vector<uint16_t> values(6);
+    reader.read_array(values.data(), 6, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+
+    ec.clear();
+    reader.skip(1, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+
+    ec.clear();
+    reader.read(sak::storage(data), ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+}
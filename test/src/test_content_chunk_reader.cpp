@@ -0,0 +1,149 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/content_chunk_reader.hpp>
+#include <sak/random_input_stream.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// Live stream where data is added by the test
+class live_input_stream : public sak::input_stream
+{
+public:
+
+    live_input_stream() :
+        m_position(0),
+        m_stopped(false)
+    { }
+
+    void add(const uint8_t* data, uint32_t bytes)
+    {
+        m_data.insert(m_data.end(), data, data + bytes);
+    }
+
+    void stop()
+    {
+        m_stopped = true;
+    }
+
+    void read(uint8_t* buffer, uint32_t bytes)
+    {
+        assert(bytes <= bytes_available());
+        std::copy_n(m_data.data() + m_position, bytes, buffer);
+        m_position += bytes;
+    }
+
+    uint32_t bytes_available()
+    {
+        return (uint32_t)m_data.size() - m_position;
+    }
+
+    bool stopped()
+    {
+        return m_stopped;
+    }
+
+    sak::const_storage peek(uint32_t max_bytes)
+    {
+        return sak::const_storage(m_data.data() + m_position,
+                                  std::min(max_bytes, bytes_available()));
+    }
+
+    void consume(uint32_t bytes)
+    {
+        assert(bytes <= bytes_available());
+        m_position += bytes;
+    }
+
+private:
+
+    std::vector<uint8_t> m_data;
+    uint32_t m_position;
+    bool m_stopped;
+};
+}
+
+/// Tests that reading a finite stream gives the chunks of split()
+TEST(TestContentChunkReader, FiniteStream)
+{
+    sak::random_input_stream stream(100000);
+    sak::content_chunker chunker(256, 1024, 4096);
+
+    auto expected = chunker.split(sak::const_storage(stream.data(), 100000));
+
+    sak::content_chunk_reader reader(stream, chunker);
+    sak::const_storage chunk;
+
+    uint32_t i = 0;
+    while (reader.read(chunk))
+    {
+        ASSERT_LT(i, expected.size());
+
+        // The random_input_stream is peeked without copying
+        EXPECT_EQ(expected[i].m_data, chunk.m_data);
+        EXPECT_EQ(expected[i].m_size, chunk.m_size);
+        ++i;
+    }
+
+    EXPECT_EQ(expected.size(), i);
+    EXPECT_EQ(100000U, reader.bytes_read());
+    EXPECT_EQ(0U, stream.bytes_available());
+}
+
+/// Tests reading a live stream as the data arrives
+TEST(TestContentChunkReader, LiveStream)
+{
+    sak::random_input_stream random(50000);
+    sak::content_chunker chunker(256, 1024, 4096);
+
+    auto expected = chunker.split(sak::const_storage(random.data(), 50000));
+
+    live_input_stream stream;
+    sak::content_chunk_reader reader(stream, chunker);
+    sak::const_storage chunk;
+
+    uint32_t i = 0;
+    uint32_t added = 0;
+
+    while (added < 50000)
+    {
+        uint32_t bytes = std::min(3000U, 50000 - added);
+        stream.add(random.data() + added, bytes);
+        added += bytes;
+
+        while (reader.read(chunk))
+        {
+            ASSERT_LT(i, expected.size());
+            EXPECT_EQ(expected[i].m_size, chunk.m_size);
+            EXPECT_TRUE(std::equal(chunk.m_data,
+                                   chunk.m_data + chunk.m_size,
+                                   expected[i].m_data));
+            ++i;
+        }
+
+        // A chunk is only cut when the maximum size is available
+        EXPECT_LT(added - reader.bytes_read(), 4096U + 3000U);
+    }
+
+    // The remaining chunks are cut when the stream stops
+    EXPECT_LT(i, expected.size());
+    stream.stop();
+
+    while (reader.read(chunk))
+    {
+        ASSERT_LT(i, expected.size());
+        EXPECT_EQ(expected[i].m_size, chunk.m_size);
+        ++i;
+    }
+
+    EXPECT_EQ(expected.size(), i);
+    EXPECT_EQ(50000U, reader.bytes_read());
+}
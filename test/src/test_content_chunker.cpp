@@ -0,0 +1,132 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/content_chunker.hpp>
+#include <sak/random_input_stream.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::set<std::string> chunk_set(const std::vector<sak::const_storage>& chunks)
+{
+    std::set<std::string> result;
+    for (const auto& chunk : chunks)
+    {
+        result.insert(std::string((const char*)chunk.m_data, chunk.m_size));
+    }
+    return result;
+}
+}
+
+/// Tests that the chunks cover the data and respect the size limits
+TEST(TestContentChunker, Split)
+{
+    sak::random_input_stream random(1000000);
+    sak::const_storage data(random.data(), 1000000);
+
+    sak::content_chunker chunker(1024, 4096, 16384);
+    EXPECT_EQ(1024U, chunker.min_size());
+    EXPECT_EQ(4096U, chunker.average_size());
+    EXPECT_EQ(16384U, chunker.max_size());
+
+    auto chunks = chunker.split(data);
+    ASSERT_FALSE(chunks.empty());
+
+    const uint8_t* position = data.m_data;
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+    {
+        EXPECT_EQ(position, chunks[i].m_data);
+        EXPECT_LE(chunks[i].m_size, 16384U);
+
+        if (i + 1 < chunks.size())
+        {
+            EXPECT_GE(chunks[i].m_size, 1024U);
+            EXPECT_EQ(chunks[i].m_size, chunker.next_boundary(
+                chunks[i].m_data, data.m_size - (position - data.m_data)));
+        }
+
+        position += chunks[i].m_size;
+    }
+
+    EXPECT_EQ(data.m_data + data.m_size, position);
+
+    // The normalized chunking keeps the sizes close to the average
+    uint32_t average = data.m_size / (uint32_t)chunks.size();
+    EXPECT_GT(average, 2048U);
+    EXPECT_LT(average, 8192U);
+}
+
+/// Tests that inserting data only changes the chunks around the
+/// insertion
+TEST(TestContentChunker, Insertion)
+{
+    sak::random_input_stream random(200000);
+    sak::content_chunker chunker(256, 1024, 4096);
+
+    std::vector<uint8_t> original(random.data(), random.data() + 200000);
+
+    std::vector<uint8_t> modified(original);
+    modified.insert(modified.begin() + 100000, 10, 0xAB);
+
+    auto original_chunks = chunk_set(chunker.split(sak::storage(original)));
+    auto modified_chunks = chunk_set(chunker.split(sak::storage(modified)));
+
+    std::vector<std::string> common;
+    std::set_intersection(original_chunks.begin(), original_chunks.end(),
+                          modified_chunks.begin(), modified_chunks.end(),
+                          std::back_inserter(common));
+
+    // Only a few chunks around the insertion may differ
+    EXPECT_GE(common.size() + 3, original_chunks.size());
+}
+
+/// Tests that data without boundaries is cut at the maximum size and
+/// that short data forms a single chunk
+TEST(TestContentChunker, Limits)
+{
+    sak::content_chunker chunker(64, 256, 1000);
+
+    std::vector<uint8_t> zeros(2500, 0);
+    auto chunks = chunker.split(sak::storage(zeros));
+
+    ASSERT_EQ(3U, chunks.size());
+    EXPECT_EQ(1000U, chunks[0].m_size);
+    EXPECT_EQ(1000U, chunks[1].m_size);
+    EXPECT_EQ(500U, chunks[2].m_size);
+
+    EXPECT_EQ(50U, chunker.next_boundary(zeros.data(), 50));
+    EXPECT_EQ(0U, chunker.next_boundary(zeros.data(), 0));
+    EXPECT_TRUE(chunker.split(sak::const_storage(0, 0)).empty());
+}
+
+/// Tests that the boundaries do not depend on the alignment of the data
+TEST(TestContentChunker, Alignment)
+{
+    sak::random_input_stream random(100001);
+    sak::content_chunker chunker(100, 512, 2048);
+
+    sak::const_storage aligned(random.data(), 100000);
+    sak::const_storage unaligned(random.data() + 1, 100000);
+
+    std::vector<uint8_t> copy(random.data() + 1, random.data() + 100001);
+
+    auto expected = chunker.split(unaligned);
+    auto chunks = chunker.split(sak::storage(copy));
+
+    ASSERT_EQ(expected.size(), chunks.size());
+    for (uint32_t i = 0; i < chunks.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].m_size, chunks[i].m_size);
+    }
+
+    EXPECT_FALSE(chunker.split(aligned).empty());
+}
@@ -5,6 +5,11 @@
 
 #include <sak/convert_endian.hpp>
 
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace
@@ -161,3 +166,286 @@ TEST(ConvertEndian, ConvertTemplate)
         EXPECT_TRUE(out == in);
     }
 }
+
+TEST(ConvertEndian, Varint)
+{
+    // Single byte values
+    {
+        uint8_t data[1];
+        EXPECT_EQ(1U, sak::varint::size(0x7FU));
+        EXPECT_EQ(1U, sak::varint::put(0x7FU, data));
+        EXPECT_EQ(0x7FU, data[0]);
+
+        uint64_t out = 0;
+        EXPECT_EQ(1U, sak::varint::get(data, sizeof(data), out));
+        EXPECT_EQ(0x7FU, out);
+    }
+
+    // Multi-byte values are written with the least significant group first
+    {
+        uint8_t data[2];
+        EXPECT_EQ(2U, sak::varint::size(300U));
+        EXPECT_EQ(2U, sak::varint::put(300U, data));
+        EXPECT_EQ(0xACU, data[0]);
+        EXPECT_EQ(0x02U, data[1]);
+
+        uint64_t out = 0;
+        EXPECT_EQ(2U, sak::varint::get(data, sizeof(data), out));
+        EXPECT_EQ(300U, out);
+
+        // A truncated value cannot be decoded
+        EXPECT_EQ(0U, sak::varint::get(data, 1, out));
+    }
+
+    // The largest 64-bit value
+    {
+        uint8_t data[10];
+        uint64_t in = std::numeric_limits<uint64_t>::max();
+        EXPECT_EQ(10U, sak::varint::max_size<uint64_t>());
+        EXPECT_EQ(5U, sak::varint::max_size<uint32_t>());
+        EXPECT_EQ(10U, sak::varint::size(in));
+        EXPECT_EQ(10U, sak::varint::put(in, data));
+
+        uint64_t out = 0;
+        EXPECT_EQ(10U, sak::varint::get(data, sizeof(data), out));
+        EXPECT_EQ(in, out);
+
+        // A tenth byte above 0x01 does not fit in 64 bits
+        data[9] = 0x02;
+        EXPECT_EQ(0U, sak::varint::get(data, sizeof(data), out));
+
+        uint64_t values[1];
+        EXPECT_EQ(0U, sak::varint::get_batch(data, sizeof(data), values, 1));
+    }
+}
+
+namespace
+{
+template<class ValueType>
+void varint_batch_test(uint32_t max_bits)
+{
+    const uint32_t count = 1000;
+    std::vector<ValueType> values(count);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        // Mix runs of small values with values of all lengths
+        uint32_t bits = (i / 16) % 2 ? (rand() % max_bits) + 1 : 7;
+        uint64_t value = ((uint64_t(rand()) << 32) ^ uint64_t(rand()) ^
+                          (uint64_t(rand()) << 48));
+        value &= ~0ULL >> (64 - bits);
+        values[i] = static_cast<ValueType>(value);
+    }
+
+    std::vector<uint8_t> data(count * sak::varint::max_size<ValueType>());
+    uint32_t written = sak::varint::put_batch(&values[0], count, &data[0]);
+
+    uint32_t expected = 0;
+    for (auto value : values)
+        expected += sak::varint::size(value);
+    EXPECT_EQ(expected, written);
+
+    std::vector<ValueType> decoded(count);
+    EXPECT_EQ(written,
+              sak::varint::get_batch(&data[0], written, &decoded[0], count));
+    EXPECT_EQ(values, decoded);
+
+    // Decoding fails if the buffer is truncated
+    EXPECT_EQ(0U, sak::varint::get_batch(
+        &data[0], written - 1, &decoded[0], count));
+}
+}
+
+TEST(ConvertEndian, VarintBatch)
+{
+    varint_batch_test<uint8_t>(8);
+    varint_batch_test<uint16_t>(16);
+    varint_batch_test<uint32_t>(32);
+    varint_batch_test<uint64_t>(64);
+
+    // Values that do not fit the requested type are rejected
+    uint8_t data[2];
+    uint32_t written = sak::varint::put(300U, data);
+    uint8_t out[1];
+    EXPECT_EQ(0U, sak::varint::get_batch(data, written, out, 1));
+}
+
+TEST(ConvertEndian, ConvertOddWidth)
+{
+    // Test 24-bit integer
+    {
+        uint8_t data[3];
+        uint32_t in = 0x112233U;
+
+        sak::big_endian::put24(in, data);
+        EXPECT_TRUE(0x11U == data[0]);
+        EXPECT_TRUE(0x22U == data[1]);
+        EXPECT_TRUE(0x33U == data[2]);
+
+        uint32_t out = sak::big_endian::get24(data);
+        EXPECT_TRUE(out == in);
+    }
+
+    // Test 40-bit integer
+    {
+        uint8_t data[5];
+        uint64_t in = 0x1122334455ULL;
+
+        sak::big_endian::put40(in, data);
+        EXPECT_TRUE(0x11U == data[0]);
+        EXPECT_TRUE(0x22U == data[1]);
+        EXPECT_TRUE(0x33U == data[2]);
+        EXPECT_TRUE(0x44U == data[3]);
+        EXPECT_TRUE(0x55U == data[4]);
+
+        uint64_t out = sak::big_endian::get40(data);
+        EXPECT_TRUE(out == in);
+    }
+
+    // Test 48-bit integer
+    {
+        uint8_t data[6];
+        uint64_t in = 0x112233445566ULL;
+
+        sak::big_endian::put48(in, data);
+        EXPECT_TRUE(0x11U == data[0]);
+        EXPECT_TRUE(0x22U == data[1]);
+        EXPECT_TRUE(0x33U == data[2]);
+        EXPECT_TRUE(0x44U == data[3]);
+        EXPECT_TRUE(0x55U == data[4]);
+        EXPECT_TRUE(0x66U == data[5]);
+
+        uint64_t out = sak::big_endian::get48(data);
+        EXPECT_TRUE(out == in);
+    }
+
+    // Test 56-bit integer
+    {
+        uint8_t data[7];
+        uint64_t in = 0x11223344556677ULL;
+
+        sak::big_endian::put56(in, data);
+        EXPECT_TRUE(0x11U == data[0]);
+        EXPECT_TRUE(0x22U == data[1]);
+        EXPECT_TRUE(0x33U == data[2]);
+        EXPECT_TRUE(0x44U == data[3]);
+        EXPECT_TRUE(0x55U == data[4]);
+        EXPECT_TRUE(0x66U == data[5]);
+        EXPECT_TRUE(0x77U == data[6]);
+
+        uint64_t out = sak::big_endian::get56(data);
+        EXPECT_TRUE(out == in);
+    }
+}
+
+TEST(ConvertEndian, ConvertTemplateBytes)
+{
+    uint8_t data[8];
+    uint64_t in = 0x1020304050607080ULL;
+
+    sak::big_endian::put<1>(in & 0xFFU, data);
+    EXPECT_EQ(0x80U, sak::big_endian::get<1>(data));
+
+    sak::big_endian::put<2>(in & 0xFFFFU, data);
+    EXPECT_EQ(0x7080U, sak::big_endian::get<2>(data));
+
+    sak::big_endian::put<3>(in & 0xFFFFFFU, data);
+    EXPECT_EQ(0x607080U, sak::big_endian::get<3>(data));
+
+    sak::big_endian::put<4>(in & 0xFFFFFFFFU, data);
+    EXPECT_EQ(0x50607080U, sak::big_endian::get<4>(data));
+
+    sak::big_endian::put<5>(in & 0xFFFFFFFFFFULL, data);
+    EXPECT_EQ(0x4050607080ULL, sak::big_endian::get<5>(data));
+
+    sak::big_endian::put<6>(in & 0xFFFFFFFFFFFFULL, data);
+    EXPECT_EQ(0x304050607080ULL, sak::big_endian::get<6>(data));
+
+    sak::big_endian::put<7>(in & 0xFFFFFFFFFFFFFFULL, data);
+    EXPECT_EQ(0x20304050607080ULL, sak::big_endian::get<7>(data));
+
+    sak::big_endian::put<8>(in, data);
+    EXPECT_EQ(in, sak::big_endian::get<8>(data));
+    EXPECT_EQ(0x10U, data[0]);
+    EXPECT_EQ(0x80U, data[7]);
+}
+
+TEST(ConvertEndian, ConvertSigned)
+{
+    uint8_t data[8];
+
+    sak::big_endian::put<int8_t>(-2, data);
+    EXPECT_EQ(0xFEU, data[0]);
+    EXPECT_EQ(-2, sak::big_endian::get<int8_t>(data));
+
+    sak::big_endian::put<int16_t>(-2, data);
+    EXPECT_EQ(0xFFU, data[0]);
+    EXPECT_EQ(0xFEU, data[1]);
+    EXPECT_EQ(-2, sak::big_endian::get<int16_t>(data));
+
+    sak::big_endian::put<int32_t>(std::numeric_limits<int32_t>::min(), data);
+    EXPECT_EQ(0x80U, data[0]);
+    EXPECT_EQ(0x00U, data[3]);
+    EXPECT_EQ(std::numeric_limits<int32_t>::min(),
+              sak::big_endian::get<int32_t>(data));
+
+    sak::big_endian::put<int64_t>(-1234567890123LL, data);
+    EXPECT_EQ(0xFFU, data[0]);
+    EXPECT_EQ(-1234567890123LL, sak::big_endian::get<int64_t>(data));
+}
+
+TEST(ConvertEndian, ConvertFloatingPoint)
+{
+    // Test float
+    {
+        uint8_t data[4];
+
+        // 1.0f is 0x3F800000 in IEEE 754 single precision
+        sak::big_endian::put<float>(1.0f, data);
+        EXPECT_EQ(0x3FU, data[0]);
+        EXPECT_EQ(0x80U, data[1]);
+        EXPECT_EQ(0x00U, data[2]);
+        EXPECT_EQ(0x00U, data[3]);
+        EXPECT_EQ(1.0f, sak::big_endian::get<float>(data));
+
+        float in = -3.14159f;
+        sak::big_endian::put<float>(in, data);
+        float out = sak::big_endian::get<float>(data);
+        EXPECT_EQ(0, std::memcmp(&in, &out, sizeof(in)));
+    }
+
+    // Test double
+    {
+        uint8_t data[8];
+
+        // 1.0 is 0x3FF0000000000000 in IEEE 754 double precision
+        sak::big_endian::put<double>(1.0, data);
+        EXPECT_EQ(0x3FU, data[0]);
+        EXPECT_EQ(0xF0U, data[1]);
+        EXPECT_EQ(0x00U, data[7]);
+        EXPECT_EQ(1.0, sak::big_endian::get<double>(data));
+
+        // The bit pattern of a NaN is preserved
+        double in = std::numeric_limits<double>::quiet_NaN();
+        sak::big_endian::put<double>(in, data);
+        double out = sak::big_endian::get<double>(data);
+        EXPECT_EQ(0, std::memcmp(&in, &out, sizeof(in)));
+    }
+}
+
+TEST(ConvertEndian, ConvertArray)
+{
+    std::vector<float> in = { 0.5f, -1.0f, 2.25f, 1e-10f, 3e30f };
+    std::vector<uint8_t> data(in.size() * sizeof(float));
+
+    sak::big_endian::put_array(in.data(), (uint32_t)in.size(), data.data());
+
+    for (uint32_t i = 0; i < in.size(); ++i)
+    {
+        EXPECT_EQ(in[i], sak::big_endian::get<float>(&data[i * 4]));
+    }
+
+    std::vector<float> out(in.size());
+    sak::big_endian::get_array(data.data(), out.data(), (uint32_t)out.size());
+    EXPECT_EQ(in, out);
+}
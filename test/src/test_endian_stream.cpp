@@ -387,3 +387,425 @@ TEST(TestEndianStream, read_write_vector)
     EXPECT_TRUE(
         std::equal(second.begin(), second.end(), second_out.begin()));
 }
+
+TEST(TestEndianStream, read_write_varint)
+{
+    const uint32_t size = 1024;
+    std::vector<uint8_t> buffer;
+    buffer.resize(size);
+
+    sak::endian_stream stream(buffer.data(), size);
+
+    stream.write_varint(1U);
+    EXPECT_EQ(1U, stream.position());
+    stream.write_varint(300U);
+    EXPECT_EQ(3U, stream.position());
+    stream.write_varint(std::numeric_limits<uint32_t>::max());
+    EXPECT_EQ(8U, stream.position());
+    stream.write_varint(std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(18U, stream.position());
+
+    // Go back to the beginning of the stream
+    stream.seek(0);
+
+    uint8_t u8 = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    uint64_t u64 = 0;
+
+    stream.read_varint(u8);
+    EXPECT_EQ(1U, u8);
+    stream.read_varint(u16);
+    EXPECT_EQ(300U, u16);
+    stream.read_varint(u32);
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(), u32);
+    stream.read_varint(u64);
+    EXPECT_EQ(std::numeric_limits<uint64_t>::max(), u64);
+    EXPECT_EQ(18U, stream.position());
+}
+
+TEST(TestEndianStream, read_write_odd_width)
+{
+    const uint32_t size = 1024;
+    std::vector<uint8_t> buffer;
+    buffer.resize(size);
+
+    sak::endian_stream stream(buffer.data(), size);
+
+    stream.write<3>(0x112233U);
+    stream.write<5>(0x1122334455ULL);
+    stream.write<6>(0x112233445566ULL);
+    stream.write<7>(0x11223344556677ULL);
+    // The fixed-size writes can still be mixed with the sized ones
+    stream.write<uint16_t>(0x1122U);
+    EXPECT_EQ(23U, stream.position());
+
+    // Go back to the beginning of the stream
+    stream.seek(0);
+
+    uint32_t u24 = 0;
+    uint64_t u40 = 0;
+    uint64_t u48 = 0;
+    uint64_t u56 = 0;
+    uint16_t u16 = 0;
+
+    stream.read<3>(u24);
+    EXPECT_EQ(0x112233U, u24);
+    stream.read<5>(u40);
+    EXPECT_EQ(0x1122334455ULL, u40);
+    stream.read<6>(u48);
+    EXPECT_EQ(0x112233445566ULL, u48);
+    stream.read<7>(u56);
+    EXPECT_EQ(0x11223344556677ULL, u56);
+    stream.read(u16);
+    EXPECT_EQ(0x1122U, u16);
+    EXPECT_EQ(23U, stream.position());
+}
+
+TEST(TestEndianStream, read_write_floating_point)
+{
+    const uint32_t size = 1024;
+    std::vector<uint8_t> buffer;
+    buffer.resize(size);
+
+    sak::endian_stream stream(buffer.data(), size);
+
+    std::vector<float> column = { 1.5f, -2.5f, 1e-3f, 42.0f };
+
+    stream.write(3.25f);
+    stream.write(-1.0e100);
+    stream.write<int32_t>(-10);
+    stream.write_array(column.data(), (uint32_t)column.size());
+    EXPECT_EQ(32U, stream.position());
+
+    // Go back to the beginning of the stream
+    stream.seek(0);
+
+    float f = 0;
+    double d = 0;
+    int32_t i = 0;
+    std::vector<float> column_out(column.size());
+
+    stream.read(f);
+    EXPECT_EQ(3.25f, f);
+    stream.read(d);
+    EXPECT_EQ(-1.0e100, d);
+    stream.read(i);
+    EXPECT_EQ(-10, i);
+    stream.read_array(column_out.data(), (uint32_t)column_out.size());
+    EXPECT_EQ(column, column_out);
+    EXPECT_EQ(32U, stream.position());
+}
+
+TEST(TestEndianStream, checked_read_write)
+{
+    std::vector<uint8_t> buffer(8);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    std::error_code ec;
+    stream.write<uint32_t>(0x01020304U, ec);
+    stream.write<3>(0x050607U, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(1U, stream.remaining_size());
+
+    // The value does not fit, the error is reported and the stream is
+    // moved to the end
+    stream.write<uint16_t>(0x0809U, ec);
+    EXPECT_EQ(sak::error::insufficient_space, ec);
+    EXPECT_EQ(8U, stream.position());
+    EXPECT_EQ(0U, stream.remaining_size());
+
+    stream.seek(0);
+    ec.clear();
+
+    uint32_t u32 = 0;
+    uint32_t u24 = 0;
+    uint64_t u64 = 0;
+    stream.read(u32, ec);
+    stream.read<3>(u24, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(0x01020304U, u32);
+    EXPECT_EQ(0x050607U, u24);
+
+    // Reading past the end fails, and all following reads fail too
+    stream.read(u64, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    ec.clear();
+
+    uint8_t u8 = 0;
+    stream.read(u8, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    EXPECT_EQ("Not enough data in the stream", ec.message());
+}
+
+TEST(TestEndianStream, checked_read_write_storage)
+{
+    std::vector<uint8_t> buffer(8);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    std::string data("abcdef");
+    std::error_code ec;
+    stream.write(sak::storage(data), ec);
+    EXPECT_FALSE(ec);
+    stream.write(sak::storage(data), ec);
+    EXPECT_EQ(sak::error::insufficient_space, ec);
+
+    stream.seek(0);
+    ec.clear();
+
+    std::string out(6, '\0');
+    stream.read(sak::storage(out), ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(data, out);
+    stream.read(sak::storage(out), ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+}
+
+TEST(TestEndianStream, checked_read_write_array)
+{
+    std::vector<uint8_t> buffer(8);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    uint16_t values[] = { 1, 2, 3, 4, 5 };
+    std::error_code ec;
+    stream.write_array(values, 5, ec);
+    EXPECT_EQ(sak::error::insufficient_space, ec);
+
+    stream.seek(0);
+    ec.clear();
+    stream.write_array(values, 4, ec);
+    EXPECT_FALSE(ec);
+
+    stream.seek(0);
+    uint16_t out[5];
+    stream.read_array(out, 4, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(4U, out[3]);
+
+    stream.seek(2);
+    stream.read_array(out, 4, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+}
+
+TEST(TestEndianStream, checked_read_write_varint)
+{
+    // The last byte has the continuation bit set
+    std::vector<uint8_t> buffer(3, 0x80);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    std::error_code ec;
+    stream.write_varint(300, ec);
+    EXPECT_FALSE(ec);
+    stream.write_varint(300, ec);
+    EXPECT_EQ(sak::error::insufficient_space, ec);
+
+    stream.seek(0);
+    ec.clear();
+
+    // The value does not fit in a uint8_t
+    uint8_t u8 = 0;
+    stream.read_varint(u8, ec);
+    EXPECT_EQ(sak::error::invalid_varint, ec);
+
+    stream.seek(0);
+    ec.clear();
+
+    uint16_t u16 = 0;
+    stream.read_varint(u16, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(300U, u16);
+
+    // The value is truncated
+    stream.read_varint(u16, ec);
+    EXPECT_EQ(sak::error::invalid_varint, ec);
+}
+
+TEST(TestEndianStream, read_view_and_peek)
+{
+    std::vector<uint8_t> buffer = { 0x00, 0x05, 'h', 'e', 'l', 'l', 'o' };
+    sak::endian_stream stream(sak::storage(buffer));
+
+    EXPECT_EQ(5U, stream.peek<uint16_t>());
+    EXPECT_EQ(0U, stream.position());
+
+    uint16_t length = 0;
+    stream.read(length);
+
+    // The view points into the buffer, nothing is copied
+    sak::const_storage payload = stream.read_view(length);
+    EXPECT_EQ(&buffer[2], payload.m_data);
+    EXPECT_EQ(5U, payload.m_size);
+    EXPECT_EQ(7U, stream.position());
+
+    std::error_code ec;
+    stream.seek(2);
+    payload = stream.read_view(6, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    EXPECT_EQ(0U, payload.m_size);
+
+    ec.clear();
+    stream.seek(2);
+    payload = stream.read_view(5, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(std::string("hello"),
+              std::string((const char*)payload.m_data, payload.m_size));
+}
+
+TEST(TestEndianStream, reserve_and_fill)
+{
+    std::vector<uint8_t> buffer(32);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    // Nested type-length-value structures encoded in a single pass
+    stream.write<uint8_t>(1);
+    auto outer_length = stream.reserve<uint16_t>();
+    EXPECT_EQ(1U, outer_length.position());
+    EXPECT_EQ(3U, stream.position());
+
+    stream.write<uint8_t>(2);
+    auto inner_length = stream.reserve<uint16_t>();
+    stream.write<uint32_t>(0xAABBCCDD);
+    stream.fill_length(inner_length);
+
+    auto checksum = stream.reserve<uint32_t>();
+    stream.fill_length(outer_length);
+    stream.fill(checksum, 0x01020304U);
+    EXPECT_EQ(14U, stream.position());
+
+    stream.seek(0);
+
+    uint8_t type = 0;
+    uint16_t length = 0;
+    uint32_t value = 0;
+
+    stream.read(type);
+    EXPECT_EQ(1U, type);
+    stream.read(length);
+    EXPECT_EQ(11U, length);
+    stream.read(type);
+    EXPECT_EQ(2U, type);
+    stream.read(length);
+    EXPECT_EQ(4U, length);
+    stream.read(value);
+    EXPECT_EQ(0xAABBCCDDU, value);
+    stream.read(value);
+    EXPECT_EQ(0x01020304U, value);
+}
+
+TEST(TestEndianStream, fill_literal)
+{
+    std::vector<uint8_t> buffer(8);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    auto type = stream.reserve<uint8_t>();
+    auto length = stream.reserve<uint16_t>();
+
+    // Integer literals convert to the type of the field
+    stream.fill(type, 7);
+    stream.fill(length, 5);
+
+    EXPECT_EQ(7U, buffer[0]);
+    EXPECT_EQ(5U, sak::big_endian::get16(&buffer[1]));
+}
+
+TEST(TestEndianStream, length_prefixed)
+{
+    std::vector<uint8_t> buffer(1024);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    std::string text("some text");
+    std::vector<uint8_t> blob(300, 'x');
+    std::vector<uint32_t> numbers = { 1, 2, 3, 0xFFFFFFFF };
+    std::vector<double> empty;
+
+    stream.write_string<uint8_t>(text);
+    EXPECT_EQ(10U, stream.position());
+    stream.write_bytes<sak::varint>(sak::storage(blob));
+    EXPECT_EQ(312U, stream.position());
+    stream.write_vector<uint16_t>(numbers);
+    EXPECT_EQ(330U, stream.position());
+    stream.write_vector<sak::varint>(empty);
+    EXPECT_EQ(331U, stream.position());
+
+    stream.seek(0);
+
+    std::string text_out;
+    stream.read_string<uint8_t>(text_out);
+    EXPECT_EQ(text, text_out);
+
+    // The blob is returned as a view into the buffer
+    sak::const_storage blob_view = stream.read_bytes<sak::varint>();
+    EXPECT_EQ(&buffer[12], blob_view.m_data);
+    EXPECT_TRUE(sak::is_equal(sak::storage(blob), blob_view));
+
+    std::vector<uint32_t> numbers_out;
+    stream.read_vector<uint16_t>(numbers_out);
+    EXPECT_EQ(numbers, numbers_out);
+
+    std::vector<double> empty_out(10);
+    stream.read_vector<sak::varint>(empty_out);
+    EXPECT_TRUE(empty_out.empty());
+    EXPECT_EQ(331U, stream.position());
+}
+
+TEST(TestEndianStream, checked_length_prefixed)
+{
+    std::vector<uint8_t> buffer =
+        { 0x00, 0x03, 'a', 'b', 'c', 0x00, 0x05, 'x' };
+    sak::endian_stream stream(sak::storage(buffer));
+
+    std::error_code ec;
+    sak::const_storage data = stream.read_bytes<uint16_t>(ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(3U, data.m_size);
+
+    // The length exceeds the data in the stream
+    data = stream.read_bytes<uint16_t>(ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    EXPECT_EQ(0U, data.m_size);
+
+    // A truncated varint length
+    std::vector<uint8_t> varint_buffer = { 0x80 };
+    sak::endian_stream varint_stream(sak::storage(varint_buffer));
+    ec.clear();
+    data = varint_stream.read_bytes<sak::varint>(ec);
+    EXPECT_EQ(sak::error::invalid_varint, ec);
+}
+
+TEST(TestEndianStream, checked_string_and_vector)
+{
+    std::vector<uint8_t> buffer(64);
+    sak::endian_stream writer(sak::storage(buffer));
+    writer.write_string<uint8_t>("abc");
+    writer.write_vector<sak::varint>(std::vector<uint32_t>{1, 2, 3});
+
+    sak::endian_stream stream(sak::storage(buffer));
+    std::error_code ec;
+
+    std::string str;
+    stream.read_string<uint8_t>(str, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ("abc", str);
+
+    std::vector<uint32_t> values;
+    stream.read_vector<sak::varint>(values, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(std::vector<uint32_t>({1, 2, 3}), values);
+
+    // A length prefix announcing far more values than the stream holds
+    // is rejected before the vector is resized
+    std::vector<uint8_t> invalid = { 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+    sak::endian_stream invalid_stream(sak::storage(invalid));
+
+    values.clear();
+    invalid_stream.read_vector<uint32_t>(values, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(0U, invalid_stream.remaining_size());
+
+    ec.clear();
+    invalid_stream.seek(0);
+    invalid_stream.read_string<uint16_t>(str, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+    EXPECT_EQ("abc", str);
+}
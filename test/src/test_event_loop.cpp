@@ -0,0 +1,333 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__linux__)
+
+#include <sak/event_loop.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+/// Tests that the loop delivers the data of several streams and removes
+/// them when they stop
+TEST(TestEventLoop, MultipleStreams)
+{
+    const uint32_t count = 4;
+
+    sak::event_loop loop;
+
+    std::vector<std::unique_ptr<sak::fd_input_stream>> streams;
+    std::vector<int> writers;
+    std::vector<std::vector<uint8_t>> received(count);
+    uint32_t stops = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        int fds[2];
+
+        // Use both pipes and Unix sockets
+        if (i % 2 == 0)
+        {
+            ASSERT_EQ(0, ::pipe(fds));
+        }
+        else
+        {
+            ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        }
+
+        streams.emplace_back(new sak::fd_input_stream(fds[0]));
+        writers.push_back(fds[1]);
+
+        sak::fd_input_stream* stream = streams.back().get();
+        std::vector<uint8_t>* data = &received[i];
+
+        stream->on_ready_read([stream, data]()
+        {
+            // Read a single byte per callback to test the re-queueing
+            uint8_t byte;
+            stream->read(&byte, 1);
+            data->push_back(byte);
+        });
+        stream->on_stopped([&stops]() { ++stops; });
+
+        loop.add(*stream);
+    }
+
+    EXPECT_EQ(count, loop.streams());
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        std::vector<uint8_t> data(i + 1, (uint8_t)i);
+        ASSERT_EQ((ssize_t)data.size(),
+                  ::write(writers[i], data.data(), data.size()));
+    }
+
+    // Every ready stream is processed once per iteration
+    EXPECT_EQ(count, loop.run_once(1000));
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(1U, received[i].size());
+        ::close(writers[i]);
+    }
+
+    loop.run();
+
+    EXPECT_EQ(0U, loop.streams());
+    EXPECT_EQ(count, stops);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(std::vector<uint8_t>(i + 1, (uint8_t)i), received[i]);
+        EXPECT_TRUE(streams[i]->stopped());
+    }
+}
+
+/// Tests removing a stream from the loop
+TEST(TestEventLoop, Remove)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    sak::event_loop loop;
+    loop.add(stream);
+    EXPECT_EQ(1U, loop.streams());
+
+    uint32_t ready_reads = 0;
+    stream.on_ready_read([&]()
+    {
+        ++ready_reads;
+        loop.remove(stream);
+    });
+
+    uint8_t byte = 42;
+    ASSERT_EQ(1, ::write(fds[1], &byte, 1));
+
+    EXPECT_EQ(1U, loop.run_once(1000));
+    EXPECT_EQ(1U, ready_reads);
+    EXPECT_EQ(0U, loop.streams());
+
+    // Nothing happens after the stream has been removed
+    EXPECT_EQ(0U, loop.run_once(0));
+    ::close(fds[1]);
+}
+
+/// Tests destroying a stream after removing it from its own callback
+TEST(TestEventLoop, RemoveAndDestroy)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    std::unique_ptr<sak::fd_input_stream> stream(
+        new sak::fd_input_stream(fds[0]));
+
+    sak::event_loop loop(4);
+    loop.add(*stream);
+
+    stream->on_ready_read([&]()
+    {
+        loop.remove(*stream);
+        stream.reset();
+    });
+
+    uint8_t byte = 42;
+    ASSERT_EQ(1, ::write(fds[1], &byte, 1));
+
+    EXPECT_EQ(1U, loop.run_once(1000));
+    EXPECT_FALSE(stream);
+    EXPECT_EQ(0U, loop.streams());
+    ::close(fds[1]);
+}
+
+/// Tests that a stream whose callback leaves the data unread is not
+/// processed again until new data arrives
+TEST(TestEventLoop, UnreadData)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    sak::event_loop loop(4);
+    loop.add(stream);
+
+    uint32_t ready_reads = 0;
+    stream.on_ready_read([&]() { ++ready_reads; });
+
+    uint8_t byte = 42;
+    ASSERT_EQ(1, ::write(fds[1], &byte, 1));
+
+    EXPECT_EQ(1U, loop.run_once(1000));
+    EXPECT_EQ(1U, ready_reads);
+
+    EXPECT_EQ(0U, loop.run_once(0));
+    EXPECT_EQ(1U, ready_reads);
+
+    ASSERT_EQ(1, ::write(fds[1], &byte, 1));
+    EXPECT_EQ(1U, loop.run_once(1000));
+    EXPECT_EQ(2U, ready_reads);
+
+    loop.remove(stream);
+    ::close(fds[1]);
+}
+
+/// Tests that a stream whose writing end has been closed is stopped
+/// when its callback leaves the data unread, so that run() returns
+TEST(TestEventLoop, HangupWithUnreadData)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    sak::event_loop loop;
+    loop.add(stream);
+
+    uint32_t ready_reads = 0;
+    uint32_t stops = 0;
+    stream.on_ready_read([&]() { ++ready_reads; });
+    stream.on_stopped([&]() { ++stops; });
+
+    uint8_t byte = 42;
+    ASSERT_EQ(1, ::write(fds[1], &byte, 1));
+    ::close(fds[1]);
+
+    loop.run();
+
+    EXPECT_EQ(1U, ready_reads);
+    EXPECT_EQ(1U, stops);
+    EXPECT_TRUE(stream.stopped());
+    EXPECT_EQ(0U, loop.streams());
+}
+
+/// Tests running the loop on several threads while the data is written
+/// from another thread
+TEST(TestEventLoop, MultipleThreads)
+{
+    const uint32_t count = 16;
+    const uint32_t bytes = 1000;
+
+    sak::event_loop loop(4);
+
+    std::vector<std::unique_ptr<sak::fd_input_stream>> streams;
+    std::vector<int> writers;
+    std::vector<std::vector<uint8_t>> received(count);
+    std::vector<std::unique_ptr<std::atomic<bool>>> busy;
+    std::atomic<uint32_t> overlaps(0);
+    std::atomic<uint32_t> stops(0);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        int fds[2];
+        ASSERT_EQ(0, ::pipe(fds));
+
+        streams.emplace_back(new sak::fd_input_stream(fds[0]));
+        writers.push_back(fds[1]);
+        busy.emplace_back(new std::atomic<bool>(false));
+
+        sak::fd_input_stream* stream = streams.back().get();
+        std::vector<uint8_t>* data = &received[i];
+        std::atomic<bool>* flag = busy.back().get();
+
+        stream->on_ready_read([stream, data, flag, &overlaps]()
+        {
+            // The callbacks of a stream must never run concurrently
+            if (flag->exchange(true))
+                ++overlaps;
+
+            uint32_t available = std::min(stream->bytes_available(), 10U);
+            std::vector<uint8_t> chunk(available);
+            stream->read(chunk.data(), available);
+            data->insert(data->end(), chunk.begin(), chunk.end());
+
+            flag->store(false);
+        });
+        stream->on_stopped([&stops]() { ++stops; });
+
+        loop.add(*stream);
+    }
+
+    std::thread writer([&]()
+    {
+        for (uint32_t chunk = 0; chunk < bytes / 100; ++chunk)
+        {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::vector<uint8_t> data(100, (uint8_t)i);
+                ASSERT_EQ(100, ::write(writers[i], data.data(), 100));
+            }
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ::close(writers[i]);
+        }
+    });
+
+    loop.run(4);
+    writer.join();
+
+    EXPECT_EQ(0U, overlaps.load());
+    EXPECT_EQ(count, stops.load());
+    EXPECT_EQ(0U, loop.streams());
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(std::vector<uint8_t>(bytes, (uint8_t)i), received[i]);
+    }
+}
+
+/// Tests posting functions to the loop from another thread and stopping
+/// the loop
+TEST(TestEventLoop, PostAndStop)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    sak::event_loop loop;
+    loop.add(stream);
+
+    std::thread::id loop_thread;
+    std::atomic<uint32_t> posted(0);
+
+    std::thread poster([&]()
+    {
+        for (uint32_t i = 0; i < 10; ++i)
+        {
+            loop.post([&]() { ++posted; });
+        }
+
+        loop.post([&]()
+        {
+            loop_thread = std::this_thread::get_id();
+            loop.stop();
+        });
+    });
+
+    // The stream keeps the loop running until it is stopped
+    loop.run(2);
+    poster.join();
+
+    EXPECT_EQ(10U, posted.load());
+    EXPECT_NE(std::thread::id(), loop_thread);
+    EXPECT_EQ(1U, loop.streams());
+
+    loop.remove(stream);
+    ::close(fds[1]);
+}
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__linux__)
+
+#include <sak/fd_input_stream.hpp>
+
+#include <cstdint>
+#include <string>
+#include <algorithm>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+/// Tests reading from a pipe without an event loop
+TEST(TestFdInputStream, ReadPipe)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+    EXPECT_EQ(fds[0], stream.native_handle());
+    EXPECT_FALSE(stream.stopped());
+    EXPECT_EQ(0U, stream.bytes_available());
+
+    uint32_t ready_reads = 0;
+    uint32_t stops = 0;
+    stream.on_ready_read([&]() { ++ready_reads; });
+    stream.on_stopped([&]() { ++stops; });
+
+    std::vector<uint8_t> data = {1, 2, 3, 4, 5};
+    ASSERT_EQ(5, ::write(fds[1], data.data(), data.size()));
+    EXPECT_EQ(5U, stream.bytes_available());
+
+    stream.process_events(false);
+    EXPECT_EQ(1U, ready_reads);
+
+    std::vector<uint8_t> result(5);
+    stream.read(result.data(), 5);
+    EXPECT_EQ(data, result);
+
+    // The end of the stream is reported once the data has been read
+    ::close(fds[1]);
+    stream.process_events(true);
+    EXPECT_TRUE(stream.stopped());
+    EXPECT_EQ(1U, stops);
+
+    stream.process_events(true);
+    EXPECT_EQ(1U, stops);
+}
+
+/// Tests that peeked data is still counted and returned by read()
+TEST(TestFdInputStream, PeekAndRead)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    std::vector<uint8_t> data = {1, 2, 3, 4, 5, 6};
+    ASSERT_EQ(6, ::write(fds[1], data.data(), data.size()));
+
+    sak::const_storage view = stream.peek(4);
+    ASSERT_EQ(4U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 4, data.begin()));
+    EXPECT_EQ(6U, stream.bytes_available());
+
+    // Peeking again returns the same data
+    stream.consume(1);
+    view = stream.peek(10);
+    ASSERT_EQ(5U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 5, data.begin() + 1));
+    EXPECT_EQ(5U, stream.bytes_available());
+
+    // The peeked data is read before new data
+    std::vector<uint8_t> more = {7, 8};
+    ASSERT_EQ(2, ::write(fds[1], more.data(), more.size()));
+
+    std::vector<uint8_t> result(7);
+    stream.read(result.data(), 7);
+    EXPECT_EQ(std::vector<uint8_t>({2, 3, 4, 5, 6, 7, 8}), result);
+    EXPECT_EQ(0U, stream.bytes_available());
+
+    ::close(fds[1]);
+}
+
+/// Tests that the end of the stream is reported by the call following
+/// the ready read callback which read the last data
+TEST(TestFdInputStream, StopAfterCallback)
+{
+    int fds[2];
+    ASSERT_EQ(0, ::pipe(fds));
+
+    sak::fd_input_stream stream(fds[0]);
+
+    std::vector<uint8_t> data = {1, 2};
+    ASSERT_EQ(2, ::write(fds[1], data.data(), data.size()));
+    ::close(fds[1]);
+
+    uint32_t stops = 0;
+    stream.on_stopped([&]() { ++stops; });
+
+    std::vector<uint8_t> result(2);
+    stream.on_ready_read([&]()
+    {
+        stream.read(result.data(), stream.bytes_available());
+        EXPECT_EQ(0U, stops);
+        EXPECT_FALSE(stream.stopped());
+    });
+
+    stream.process_events(true);
+    EXPECT_EQ(data, result);
+    EXPECT_TRUE(stream.hangup());
+    EXPECT_EQ(0U, stops);
+
+    stream.process_events(false);
+    EXPECT_TRUE(stream.stopped());
+    EXPECT_EQ(1U, stops);
+}
+
+#endif
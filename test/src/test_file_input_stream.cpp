@@ -124,3 +124,31 @@ TEST(TestFileInputStream, ThrowExceptionInConstructor)
     EXPECT_EQ(std::string("Failed to open file"), ec.message());
     EXPECT_STREQ(ec.category().name(), "sak");
 }
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <unistd.h>
+
+/// Tests that files which do not fit in 32 bits are rejected
+TEST(TestFileInputStream, FileTooLarge)
+{
+    std::string file_name("test_too_large.bin");
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+    }
+
+    // Create a sparse file of 4 GiB
+    ASSERT_EQ(0, ::truncate(file_name.c_str(), 0x100000000LL));
+
+    sak::file_input_stream fs;
+
+    std::error_code ec;
+    fs.open(file_name, ec);
+    EXPECT_EQ(sak::error::file_too_large, ec);
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+#endif
@@ -0,0 +1,177 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sak/file_output_stream.hpp>
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::vector<uint8_t> read_file(const std::string& file_name)
+{
+    std::ifstream file(file_name.c_str(), std::ios::in | std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(file),
+                                std::istreambuf_iterator<char>());
+}
+}
+
+/// Tests that small writes are coalesced until flush
+TEST(TestFileOutputStream, CoalesceAndFlush)
+{
+    std::string file_name("test_output.bin");
+
+    sak::file_output_stream fs(file_name, 16);
+    EXPECT_TRUE(fs.is_open());
+
+    std::vector<uint8_t> data = {1, 2, 3, 4, 5};
+    fs.write(data.data(), 3);
+    fs.write(data.data() + 3, 2);
+
+    EXPECT_EQ(5U, fs.buffered_bytes());
+    EXPECT_EQ(5U, fs.bytes_written());
+    EXPECT_TRUE(read_file(file_name).empty());
+
+    fs.flush();
+    EXPECT_EQ(0U, fs.buffered_bytes());
+    EXPECT_EQ(data, read_file(file_name));
+
+    fs.close();
+    EXPECT_FALSE(fs.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that writes larger than the buffer are written together with the
+/// buffered data
+TEST(TestFileOutputStream, WriteSequence)
+{
+    std::string file_name("test_output.bin");
+
+    std::vector<uint8_t> header = {0xAA, 0xBB};
+    std::vector<uint8_t> payload(1000);
+
+    for (auto& v : payload)
+    {
+        v = rand() % 255;
+    }
+
+    std::vector<uint8_t> expected = {0x01};
+    expected.insert(expected.end(), header.begin(), header.end());
+    expected.insert(expected.end(), payload.begin(), payload.end());
+
+    {
+        sak::file_output_stream fs(file_name, 64);
+        sak::output_stream& output = fs;
+
+        output.write(expected.data(), 1);
+
+        std::vector<sak::const_storage> sequence;
+        sequence.push_back(sak::storage(header));
+        sequence.push_back(sak::storage(payload));
+        output.write(sequence.data(), sequence.data() + sequence.size());
+
+        // Everything went out in the write
+        EXPECT_EQ(0U, fs.buffered_bytes());
+        EXPECT_EQ(expected.size(), fs.bytes_written());
+        EXPECT_EQ(expected, read_file(file_name));
+
+        // The destructor flushes the buffered data
+        output.write(expected.data(), 1);
+    }
+
+    expected.push_back(0x01);
+    EXPECT_EQ(expected, read_file(file_name));
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests writing a sequence with more buffers than a single writev()
+/// batch
+TEST(TestFileOutputStream, WriteLongSequence)
+{
+    std::string file_name("test_output.bin");
+
+    std::vector<uint8_t> data(1000);
+    for (uint32_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    {
+        sak::file_output_stream fs(file_name, 16);
+        fs.write(data.data(), 5);
+
+        std::vector<sak::const_storage> sequence =
+            sak::split_storage(sak::const_storage(data.data() + 5, 995), 3);
+        fs.write(sequence.data(), sequence.data() + sequence.size());
+
+        EXPECT_EQ(1000U, fs.bytes_written());
+        EXPECT_EQ(0U, fs.buffered_bytes());
+    }
+
+    EXPECT_EQ(data, read_file(file_name));
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+#if defined(__linux__)
+/// Tests that only the bytes reaching the file are counted after an
+/// error
+TEST(TestFileOutputStream, WriteError)
+{
+    // Writes to /dev/full fail with ENOSPC
+    sak::file_output_stream fs("/dev/full", 16);
+
+    std::vector<uint8_t> data(100, 0x42);
+    fs.write(data.data(), 10);
+    EXPECT_EQ(10U, fs.bytes_written());
+
+    std::error_code ec;
+    fs.write(data.data(), 100, ec);
+    EXPECT_EQ(sak::error::failed_write_file, ec);
+    EXPECT_EQ(0U, fs.bytes_written());
+    EXPECT_EQ(0U, fs.buffered_bytes());
+}
+#endif
+
+/// Tests error handling with error code
+TEST(TestFileOutputStream, ReturnErrorCode)
+{
+    sak::file_output_stream fs;
+
+    std::error_code ec;
+    fs.open("directory_that_should_not_exist/file.bin", ec);
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+    EXPECT_FALSE(fs.is_open());
+}
+
+/// Tests error handling with exception in constructor
+TEST(TestFileOutputStream, ThrowExceptionInConstructor)
+{
+    std::error_code ec;
+
+    try
+    {
+        sak::file_output_stream fs(
+            "directory_that_should_not_exist/file.bin");
+    }
+    catch (const std::system_error& error)
+    {
+        ec = error.code();
+    }
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+}
+
+#endif
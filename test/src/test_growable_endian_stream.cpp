@@ -0,0 +1,142 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/growable_endian_stream.hpp>
+#include <sak/endian_stream.hpp>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestGrowableEndianStream, write_to_buffer)
+{
+    sak::buffer buffer;
+    const uint32_t elements = 1000;
+
+    {
+        sak::growable_endian_stream<sak::buffer> stream(buffer);
+        EXPECT_EQ(0U, stream.size());
+        EXPECT_EQ(0U, stream.position());
+
+        for (uint32_t i = 0; i < elements; ++i)
+        {
+            stream.write(i);
+            stream.write<uint8_t>(i % 256);
+        }
+
+        EXPECT_EQ(elements * 5, stream.size());
+        EXPECT_EQ(elements * 5, stream.position());
+        EXPECT_GE(stream.capacity(), stream.size());
+    }
+
+    // The buffer is trimmed when the stream is destroyed
+    ASSERT_EQ(elements * 5, buffer.size());
+
+    sak::endian_stream reader(buffer.data(), buffer.size());
+    for (uint32_t i = 0; i < elements; ++i)
+    {
+        uint32_t value = 0;
+        uint8_t byte = 0;
+        reader.read(value);
+        reader.read(byte);
+        EXPECT_EQ(i, value);
+        EXPECT_EQ(i % 256, byte);
+    }
+}
+
+TEST(TestGrowableEndianStream, append_to_buffer)
+{
+    std::string hello("hello");
+
+    sak::buffer buffer;
+    buffer.append(sak::storage(hello));
+
+    sak::growable_endian_stream<sak::buffer> stream(buffer);
+    EXPECT_EQ(5U, stream.size());
+    EXPECT_EQ(5U, stream.position());
+
+    stream.write<3>(0x010203U);
+    stream.write_varint(300);
+    stream.write(sak::storage(hello));
+
+    uint16_t values[] = { 1, 2 };
+    stream.write_array(values, 2);
+    EXPECT_EQ(19U, stream.size());
+
+    // Seek back and overwrite
+    stream.seek(5);
+    stream.write<uint8_t>(0xFF);
+    EXPECT_EQ(6U, stream.position());
+    EXPECT_EQ(19U, stream.size());
+
+    stream.trim();
+    EXPECT_EQ(19U, stream.capacity());
+    ASSERT_EQ(19U, buffer.size());
+
+    const uint8_t expected[] =
+    {
+        'h', 'e', 'l', 'l', 'o', 0xFF, 0x02, 0x03, 0xAC, 0x02,
+        'h', 'e', 'l', 'l', 'o', 0x00, 0x01, 0x00, 0x02
+    };
+
+    EXPECT_TRUE(sak::is_equal(sak::storage(expected, sizeof(expected)),
+                              sak::const_storage(buffer.data(), 19)));
+}
+
+TEST(TestGrowableEndianStream, write_to_duplex_buffer)
+{
+    sak::duplex_buffer buffer(0, 16, 0);
+
+    {
+        sak::growable_endian_stream<sak::duplex_buffer> stream(buffer);
+        for (uint32_t i = 0; i < 100; ++i)
+        {
+            stream.write<uint64_t>(i);
+        }
+    }
+
+    ASSERT_EQ(800U, buffer.size());
+
+    // The front capacity can still be used for a header
+    buffer.resize_front(buffer.size() + 4);
+    sak::big_endian::put32(800, buffer.data());
+
+    sak::endian_stream reader(buffer.data(), buffer.size());
+    uint32_t length = 0;
+    reader.read(length);
+    EXPECT_EQ(800U, length);
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        uint64_t value = 0;
+        reader.read(value);
+        EXPECT_EQ(i, value);
+    }
+}
+
+TEST(TestGrowableEndianStream, reserve_and_fill)
+{
+    sak::buffer buffer;
+
+    {
+        sak::growable_endian_stream<sak::buffer> stream(buffer);
+
+        auto type = stream.reserve<uint16_t>();
+        auto length = stream.reserve<uint32_t>();
+
+        // Grow the buffer after the reservation
+        std::vector<uint8_t> payload(1000, 'x');
+        stream.write(sak::storage(payload));
+
+        stream.fill_length(length);
+        stream.fill(type, 5);
+        EXPECT_EQ(1006U, stream.position());
+    }
+
+    ASSERT_EQ(1006U, buffer.size());
+    EXPECT_EQ(5U, sak::big_endian::get16(buffer.data()));
+    EXPECT_EQ(1000U, sak::big_endian::get32(buffer.data() + 2));
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/header_layout.hpp>
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// A 2-byte magic, 1-byte version, 3-byte length and 8-byte timestamp
+typedef sak::header_layout<2, 1, 3, 8> test_header;
+
+// The header is built at compile-time
+constexpr test_header::header_type header_template =
+    test_header::make(0xCAFE, 1, 0, 0x0102030405060708ULL);
+
+static_assert(test_header::fields == 4, "Wrong number of fields");
+static_assert(test_header::size == 14, "Wrong header size");
+static_assert(test_header::offset<0>() == 0, "Wrong offset");
+static_assert(test_header::offset<1>() == 2, "Wrong offset");
+static_assert(test_header::offset<2>() == 3, "Wrong offset");
+static_assert(test_header::offset<3>() == 6, "Wrong offset");
+static_assert(test_header::field_size<2>() == 3, "Wrong field size");
+
+// The getters can be used in constant expressions
+constexpr uint8_t magic[] = { 0xCA, 0xFE, 0xBA, 0xBE };
+static_assert(sak::big_endian::get32(magic) == 0xCAFEBABE, "Wrong value");
+static_assert(sak::big_endian::get<uint16_t>(magic) == 0xCAFE, "Wrong value");
+static_assert(sak::big_endian::get<3>(magic) == 0xCAFEBA, "Wrong value");
+}
+
+TEST(TestHeaderLayout, make)
+{
+    const uint8_t expected[] =
+    {
+        0xCA, 0xFE, 0x01, 0x00, 0x00, 0x00,
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+    };
+
+    ASSERT_EQ(sizeof(expected), header_template.size());
+    EXPECT_EQ(0, std::memcmp(expected, header_template.data(),
+                             sizeof(expected)));
+}
+
+TEST(TestHeaderLayout, patch_fields)
+{
+    uint8_t buffer[test_header::size];
+    std::memcpy(buffer, header_template.data(), test_header::size);
+
+    test_header::put<2>(0x123456, buffer);
+    EXPECT_EQ(0x12U, buffer[3]);
+    EXPECT_EQ(0x34U, buffer[4]);
+    EXPECT_EQ(0x56U, buffer[5]);
+
+    // The other fields are untouched
+    EXPECT_EQ(0xCAFEU, test_header::get<0>(buffer));
+    EXPECT_EQ(1U, test_header::get<1>(buffer));
+    EXPECT_EQ(0x123456U, test_header::get<2>(buffer));
+    EXPECT_EQ(0x0102030405060708ULL, test_header::get<3>(buffer));
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/input_stream.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// Live stream producing the data of a vector
+class dummy_input_stream : public sak::input_stream
+{
+public:
+
+    dummy_input_stream(const std::vector<uint8_t>& data) :
+        m_data(data),
+        m_position(0)
+    { }
+
+    void read(uint8_t* buffer, uint32_t bytes)
+    {
+        assert(bytes <= bytes_available());
+        std::copy_n(m_data.data() + m_position, bytes, buffer);
+        m_position += bytes;
+    }
+
+    uint32_t bytes_available()
+    {
+        return (uint32_t)m_data.size() - m_position;
+    }
+
+    bool stopped()
+    {
+        return false;
+    }
+
+    sak::const_storage peek(uint32_t max_bytes)
+    {
+        return sak::const_storage(m_data.data() + m_position,
+                                  std::min(max_bytes, bytes_available()));
+    }
+
+    void consume(uint32_t bytes)
+    {
+        assert(bytes <= bytes_available());
+        m_position += bytes;
+    }
+
+private:
+
+    std::vector<uint8_t> m_data;
+    uint32_t m_position;
+};
+}
+
+/// Tests the default implementation of the vectored read
+TEST(TestInputStream, DefaultReadSequence)
+{
+    std::vector<uint8_t> data = {1, 2, 3, 4, 5, 6};
+    dummy_input_stream stream(data);
+    sak::input_stream& input = stream;
+
+    std::vector<uint8_t> first(2);
+    std::vector<uint8_t> second(4);
+
+    std::vector<sak::mutable_storage> sequence;
+    sequence.push_back(sak::storage(first));
+    sequence.push_back(sak::mutable_storage());
+    sequence.push_back(sak::storage(second));
+
+    input.read(sequence.data(), sequence.data() + sequence.size());
+
+    EXPECT_EQ(std::vector<uint8_t>({1, 2}), first);
+    EXPECT_EQ(std::vector<uint8_t>({3, 4, 5, 6}), second);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/message_schema.hpp>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+struct test_message
+{
+    uint8_t m_flags;
+    uint16_t m_type;
+    uint32_t m_length;
+    int64_t m_timestamp;
+    float m_value;
+};
+
+typedef sak::message_schema<test_message,
+    sak::schema_field<test_message, uint8_t, &test_message::m_flags>,
+    sak::schema_field<test_message, uint16_t, &test_message::m_type>,
+    sak::schema_field<test_message, uint32_t, &test_message::m_length, 3>,
+    sak::schema_field<test_message, int64_t, &test_message::m_timestamp>,
+    sak::schema_field<test_message, float, &test_message::m_value>>
+    test_schema;
+
+static_assert(test_schema::size == 18, "Wrong encoded size");
+}
+
+TEST(TestMessageSchema, encode_decode)
+{
+    test_message in;
+    in.m_flags = 0x01;
+    in.m_type = 0x0203;
+    in.m_length = 0x040506;
+    in.m_timestamp = 0x0708090A0B0C0D0ELL;
+    in.m_value = 1.0f;
+
+    uint8_t buffer[test_schema::size];
+    test_schema::encode(in, buffer);
+
+    const uint8_t expected[] =
+    {
+        0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+        0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x3F, 0x80, 0x00, 0x00
+    };
+
+    EXPECT_TRUE(sak::is_equal(sak::storage(expected, sizeof(expected)),
+                              sak::storage(buffer, sizeof(buffer))));
+
+    test_message out;
+    test_schema::decode(buffer, out);
+    EXPECT_EQ(in.m_flags, out.m_flags);
+    EXPECT_EQ(in.m_type, out.m_type);
+    EXPECT_EQ(in.m_length, out.m_length);
+    EXPECT_EQ(in.m_timestamp, out.m_timestamp);
+    EXPECT_EQ(in.m_value, out.m_value);
+}
+
+TEST(TestMessageSchema, read_write_stream)
+{
+    std::vector<uint8_t> buffer(test_schema::size * 2 + 1);
+    sak::endian_stream stream(sak::storage(buffer));
+
+    test_message in = { 1, 2, 3, -4, 5.0f };
+    stream.write<uint8_t>(0xFF);
+    test_schema::write(stream, in);
+    EXPECT_EQ(test_schema::size + 1, stream.position());
+
+    std::error_code ec;
+    test_schema::write(stream, in, ec);
+    EXPECT_FALSE(ec);
+
+    // There is no room for a third message
+    test_schema::write(stream, in, ec);
+    EXPECT_EQ(sak::error::insufficient_space, ec);
+
+    stream.seek(1);
+    ec.clear();
+
+    test_message out;
+    test_schema::read(stream, out);
+    EXPECT_EQ(-4, out.m_timestamp);
+
+    out = test_message();
+    test_schema::read(stream, out, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(1U, out.m_flags);
+    EXPECT_EQ(2U, out.m_type);
+    EXPECT_EQ(3U, out.m_length);
+    EXPECT_EQ(-4, out.m_timestamp);
+    EXPECT_EQ(5.0f, out.m_value);
+    EXPECT_EQ(stream.size(), stream.position());
+
+    test_schema::read(stream, out, ec);
+    EXPECT_EQ(sak::error::insufficient_data, ec);
+}
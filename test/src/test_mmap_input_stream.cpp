@@ -0,0 +1,132 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sak/mmap_input_stream.hpp>
+
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+void write_file(const std::string& file_name,
+                const std::vector<uint8_t>& data)
+{
+    std::ofstream file(file_name.c_str(), std::ios::out | std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+}
+
+/// Tests reading and peeking into a mapped file
+TEST(TestMmapInputStream, ReadAndPeek)
+{
+    std::string file_name("test_mmap.bin");
+
+    std::vector<uint8_t> data(1000);
+    for (uint32_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = (uint8_t)(i * 3);
+    }
+    write_file(file_name, data);
+
+    sak::mmap_input_stream ms(file_name, true);
+    EXPECT_TRUE(ms.is_open());
+    EXPECT_TRUE(ms.stopped());
+    EXPECT_EQ(1000U, ms.size());
+    EXPECT_EQ(1000U, ms.bytes_available());
+
+    ms.advise(sak::access_pattern::random);
+
+    // Peeking does not move the read position
+    ms.seek(100);
+    sak::const_storage view = ms.peek(50);
+    EXPECT_EQ(ms.data() + 100, view.m_data);
+    EXPECT_EQ(50U, view.m_size);
+    EXPECT_EQ(100U, ms.read_position());
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 50,
+                           data.begin() + 100));
+
+    // Peeking is limited to the available data
+    ms.consume(850);
+    view = ms.peek(100);
+    EXPECT_EQ(ms.data() + 950, view.m_data);
+    EXPECT_EQ(50U, view.m_size);
+
+    ms.seek(100);
+    std::vector<uint8_t> buffer(900);
+    ms.read(buffer.data(), 900);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), data.begin() + 100));
+    EXPECT_EQ(0U, ms.bytes_available());
+
+    ms.close();
+    EXPECT_FALSE(ms.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that an empty file can be opened
+TEST(TestMmapInputStream, EmptyFile)
+{
+    std::string file_name("test_mmap_empty.bin");
+    write_file(file_name, std::vector<uint8_t>());
+
+    sak::mmap_input_stream ms;
+
+    std::error_code ec;
+    ms.open(file_name, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(0U, ms.size());
+    EXPECT_EQ(0U, ms.peek(0).m_size);
+
+    ms.advise(sak::access_pattern::sequential);
+    ms.close();
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests error handling with error code
+TEST(TestMmapInputStream, ReturnErrorCode)
+{
+    sak::mmap_input_stream ms;
+
+    std::error_code ec;
+    ms.open("strange_file_that_should_not_exist.notfound", ec);
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+    EXPECT_FALSE(ms.is_open());
+}
+
+/// Tests that files which do not fit in 32 bits are rejected
+TEST(TestMmapInputStream, FileTooLarge)
+{
+    std::string file_name("test_too_large.bin");
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+    }
+
+    // Create a sparse file of 4 GiB and one byte
+    ASSERT_EQ(0, ::truncate(file_name.c_str(), 0x100000001LL));
+
+    sak::mmap_input_stream stream;
+
+    std::error_code ec;
+    stream.open(file_name, ec);
+    EXPECT_EQ(sak::error::file_too_large, ec);
+    EXPECT_FALSE(stream.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+#endif
@@ -0,0 +1,264 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/parallel_reader.hpp>
+#include <sak/buffer_input_stream.hpp>
+#include <sak/file_input_stream.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+std::vector<uint8_t> random_vector(uint32_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (auto& value : data)
+    {
+        value = rand() % 256;
+    }
+    return data;
+}
+
+// Stream failing to read the block at a given offset, either by throwing
+// or by leaving the read position unchanged
+class failing_input_stream : public sak::buffer_input_stream
+{
+public:
+
+    failing_input_stream(const std::vector<uint8_t>& data,
+                         uint32_t failing_offset, bool throws) :
+        sak::buffer_input_stream(sak::storage(data)),
+        m_failing_offset(failing_offset),
+        m_throws(throws)
+    { }
+
+    using sak::buffer_input_stream::read;
+
+    void read(uint8_t* buffer, uint32_t bytes)
+    {
+        if (read_position() != m_failing_offset)
+        {
+            sak::buffer_input_stream::read(buffer, bytes);
+        }
+        else if (m_throws)
+        {
+            throw std::runtime_error("read failed");
+        }
+    }
+
+private:
+
+    uint32_t m_failing_offset;
+    bool m_throws;
+};
+
+sak::parallel_reader::stream_factory
+buffer_factory(const std::vector<uint8_t>& data)
+{
+    return [&data]()
+    {
+        return std::make_shared<sak::buffer_input_stream>(
+            sak::storage(data));
+    };
+}
+}
+
+/// Tests that the blocks are delivered in stream order
+TEST(TestParallelReader, InOrder)
+{
+    std::vector<uint8_t> data = random_vector(10000);
+
+    sak::parallel_reader reader(buffer_factory(data), 768, 4);
+    EXPECT_EQ(10000U, reader.size());
+    EXPECT_EQ(768U, reader.block_size());
+    EXPECT_EQ(14U, reader.blocks());
+    EXPECT_EQ(4U, reader.threads());
+
+    std::vector<uint8_t> result;
+    uint32_t next = 0;
+
+    reader.read([&](uint32_t index, const sak::const_storage& block)
+    {
+        EXPECT_EQ(next, index);
+        EXPECT_EQ(index < 13 ? 768U : 16U, block.m_size);
+
+        result.insert(result.end(), block.m_data,
+                      block.m_data + block.m_size);
+        ++next;
+    });
+
+    EXPECT_EQ(14U, next);
+    EXPECT_EQ(data, result);
+}
+
+/// Tests that every block is delivered once in any order
+TEST(TestParallelReader, OutOfOrder)
+{
+    std::vector<uint8_t> data = random_vector(10000);
+
+    sak::parallel_reader reader(buffer_factory(data), 1000, 3);
+    EXPECT_EQ(10U, reader.blocks());
+
+    std::vector<uint8_t> result(10000);
+    std::vector<uint32_t> delivered(10, 0);
+
+    reader.read([&](uint32_t index, const sak::const_storage& block)
+    {
+        ASSERT_LT(index, 10U);
+        EXPECT_EQ(1000U, block.m_size);
+
+        std::copy_n(block.m_data, block.m_size,
+                    result.begin() + index * 1000);
+        ++delivered[index];
+    }, false);
+
+    EXPECT_EQ(std::vector<uint32_t>(10, 1), delivered);
+    EXPECT_EQ(data, result);
+
+    // The reader can be used again
+    uint32_t blocks = 0;
+    reader.read([&](uint32_t, const sak::const_storage&)
+    {
+        ++blocks;
+    }, false);
+
+    EXPECT_EQ(10U, blocks);
+}
+
+/// Tests that an exception thrown by the callback stops the workers
+TEST(TestParallelReader, CallbackThrows)
+{
+    std::vector<uint8_t> data = random_vector(10000);
+
+    sak::parallel_reader reader(buffer_factory(data), 100, 2);
+
+    uint32_t blocks = 0;
+    EXPECT_THROW(reader.read([&](uint32_t, const sak::const_storage&)
+    {
+        if (++blocks == 5)
+            throw std::runtime_error("stop");
+    }), std::runtime_error);
+
+    EXPECT_EQ(5U, blocks);
+}
+
+/// Tests that an exception thrown by a worker stream is rethrown
+TEST(TestParallelReader, ReadThrows)
+{
+    std::vector<uint8_t> data = random_vector(10000);
+
+    sak::parallel_reader reader([&data]()
+    {
+        return std::make_shared<failing_input_stream>(data, 5000, true);
+    }, 100, 2);
+
+    uint32_t blocks = 0;
+    EXPECT_THROW(reader.read([&](uint32_t index, const sak::const_storage&)
+    {
+        EXPECT_LT(index, 50U);
+        ++blocks;
+    }), std::runtime_error);
+
+    EXPECT_LE(blocks, 50U);
+}
+
+/// Tests that a read which does not move past the block is reported
+TEST(TestParallelReader, ReadFails)
+{
+    std::vector<uint8_t> data = random_vector(10000);
+
+    sak::parallel_reader reader([&data]()
+    {
+        return std::make_shared<failing_input_stream>(data, 0, false);
+    }, 100, 2);
+
+    uint32_t blocks = 0;
+    try
+    {
+        reader.read([&](uint32_t, const sak::const_storage&)
+        {
+            ++blocks;
+        });
+        ADD_FAILURE() << "read() did not throw";
+    }
+    catch (const std::system_error& error)
+    {
+        EXPECT_EQ(sak::error::failed_read_file, error.code());
+    }
+
+    // The first block fails, so nothing is delivered in order
+    EXPECT_EQ(0U, blocks);
+}
+
+/// Tests reading a file with a stream per worker
+TEST(TestParallelReader, File)
+{
+    std::string file_name("test_parallel_reader.bin");
+    std::vector<uint8_t> data = random_vector(100000);
+
+    {
+        std::ofstream file(file_name.c_str(),
+                           std::ios::out | std::ios::binary);
+        file.write((const char*)data.data(), data.size());
+    }
+
+    {
+        sak::parallel_reader reader([&file_name]()
+        {
+            return std::make_shared<sak::file_input_stream>(file_name);
+        }, 4096, 4);
+
+        EXPECT_EQ(100000U, reader.size());
+        EXPECT_EQ(25U, reader.blocks());
+
+        std::vector<uint8_t> result;
+        reader.read([&](uint32_t, const sak::const_storage& block)
+        {
+            result.insert(result.end(), block.m_data,
+                          block.m_data + block.m_size);
+        });
+
+        EXPECT_EQ(data, result);
+    }
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests reading an empty file
+TEST(TestParallelReader, Empty)
+{
+    std::string file_name("test_parallel_reader_empty.bin");
+    std::ofstream(file_name.c_str(), std::ios::out | std::ios::binary);
+
+    {
+        sak::parallel_reader reader([&file_name]()
+        {
+            return std::make_shared<sak::file_input_stream>(file_name);
+        }, 100, 2);
+
+        EXPECT_EQ(0U, reader.size());
+        EXPECT_EQ(0U, reader.blocks());
+
+        uint32_t blocks = 0;
+        reader.read([&](uint32_t, const sak::const_storage&)
+        {
+            ++blocks;
+        });
+
+        EXPECT_EQ(0U, blocks);
+    }
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/peek_buffer.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+void append(sak::peek_buffer& buffer, const std::vector<uint8_t>& data)
+{
+    uint8_t* destination = buffer.prepare((uint32_t)data.size());
+    std::copy(data.begin(), data.end(), destination);
+    buffer.commit((uint32_t)data.size());
+}
+}
+
+/// Tests appending, peeking and consuming data
+TEST(TestPeekBuffer, PeekAndConsume)
+{
+    sak::peek_buffer buffer;
+    EXPECT_EQ(0U, buffer.size());
+    EXPECT_EQ(0U, buffer.data(10).m_size);
+
+    append(buffer, {1, 2, 3, 4, 5});
+    EXPECT_EQ(5U, buffer.size());
+
+    sak::const_storage view = buffer.data(3);
+    ASSERT_EQ(3U, view.m_size);
+    EXPECT_EQ(1U, view.m_data[0]);
+
+    buffer.consume(2);
+    EXPECT_EQ(3U, buffer.size());
+
+    // Only part of the prepared bytes are written
+    uint8_t* destination = buffer.prepare(4);
+    destination[0] = 6;
+    buffer.commit(1);
+
+    view = buffer.data(10);
+    EXPECT_EQ(std::vector<uint8_t>({3, 4, 5, 6}),
+              std::vector<uint8_t>(view.m_data, view.m_data + view.m_size));
+
+    buffer.consume(4);
+    EXPECT_EQ(0U, buffer.size());
+}
+
+/// Tests that read() copies and removes at most the buffered bytes
+TEST(TestPeekBuffer, Read)
+{
+    sak::peek_buffer buffer;
+    append(buffer, {1, 2, 3, 4});
+
+    std::vector<uint8_t> result(3);
+    EXPECT_EQ(3U, buffer.read(result.data(), 3));
+    EXPECT_EQ(std::vector<uint8_t>({1, 2, 3}), result);
+
+    EXPECT_EQ(1U, buffer.read(result.data(), 3));
+    EXPECT_EQ(4U, result[0]);
+    EXPECT_EQ(0U, buffer.read(result.data(), 3));
+}
+
+/// Tests that the data is kept in order when the consumed bytes are
+/// moved out of the way
+TEST(TestPeekBuffer, Compact)
+{
+    sak::peek_buffer buffer;
+    std::vector<uint8_t> expected;
+
+    uint8_t value = 0;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        std::vector<uint8_t> data(7);
+        for (auto& v : data)
+        {
+            v = value++;
+        }
+        append(buffer, data);
+        expected.insert(expected.end(), data.begin(), data.end());
+
+        buffer.consume(5);
+        expected.erase(expected.begin(), expected.begin() + 5);
+
+        sak::const_storage view = buffer.data(buffer.size());
+        ASSERT_EQ(expected.size(), view.m_size);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                               view.m_data));
+    }
+}
@@ -0,0 +1,393 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sak/pread_file_input_stream.hpp>
+
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+/// Tests reading a file, the file is crated a priori
+TEST(TestPreadFileInputStream, ReadRandomFile)
+{
+    // Create a file with random contents
+    uint32_t file_size = 1000;
+    std::string file_name("test.txt");
+
+    std::vector<uint8_t> output_buffer(file_size, '\0');
+
+    for (uint32_t i = 0; i < file_size; ++i)
+    {
+        output_buffer[i] = (rand() % 255);
+    }
+
+    std::ofstream output_file(
+        file_name.c_str(), std::ios::out | std::ios::binary);
+
+    ASSERT_TRUE(output_file.is_open());
+
+    output_file.write(reinterpret_cast<char*>(&output_buffer[0]), file_size);
+    output_file.close();
+
+    // Now test we can read it back
+    sak::pread_file_input_stream fs(file_name);
+
+    EXPECT_EQ(file_size, fs.bytes_available());
+    EXPECT_EQ(file_size, fs.size());
+    EXPECT_TRUE(fs.stopped());
+
+    fs.seek(0);
+    EXPECT_EQ(0U, fs.read_position());
+
+    uint32_t read_size = 512;
+
+    std::vector<uint8_t> input_buffer;
+
+    // Read until data is available
+    while (fs.bytes_available() > 0)
+    {
+        uint32_t read = std::min(read_size, fs.bytes_available());
+
+        ASSERT_TRUE(read <= read_size);
+
+        std::vector<uint8_t> temp(read, '\0');
+        fs.read(&temp[0], read);
+
+        input_buffer.insert(input_buffer.end(), temp.begin(), temp.end());
+    }
+    EXPECT_EQ(file_size, fs.read_position());
+
+    // Always close the input file stream
+    fs.close();
+
+    bool result =
+        std::equal(input_buffer.begin(), input_buffer.end(),
+                   output_buffer.begin());
+
+    ASSERT_TRUE(result);
+
+    // Make sure that test.txt is removed after the test
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests error handling with exception
+TEST(TestPreadFileInputStream, ThrowExceptionInOpen)
+{
+    sak::pread_file_input_stream fs;
+    std::error_code ec;
+
+    try
+    {
+        fs.open("strange_file_that_should_not_exist.notfound");
+    }
+    catch (const std::system_error& error)
+    {
+        ec = error.code();
+    }
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+}
+
+/// Tests error handling with error code
+TEST(TestPreadFileInputStream, ReturnErrorCode)
+{
+    sak::pread_file_input_stream fs;
+
+    std::error_code ec;
+    fs.open("strange_file_that_should_not_exist.notfound", ec);
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+}
+
+/// Tests error handling with exception in constructor
+TEST(TestPreadFileInputStream, ThrowExceptionInConstructor)
+{
+    std::error_code ec;
+
+    try
+    {
+        sak::pread_file_input_stream fs(
+            "strange_file_that_should_not_exist.notfound");
+    }
+    catch (const std::system_error& error)
+    {
+        ec = error.code();
+    }
+
+    EXPECT_EQ(ec, sak::error::failed_open_file);
+    EXPECT_EQ(std::string("Failed to open file"), ec.message());
+    EXPECT_STREQ(ec.category().name(), "sak");
+}
+
+/// Tests small reads through the internal buffer, seeking and large reads
+/// bypassing the buffer
+TEST(TestPreadFileInputStream, BufferedAndLargeReads)
+{
+    uint32_t file_size = 1000;
+    std::string file_name("test_buffered.bin");
+
+    std::vector<uint8_t> data(file_size);
+    for (uint32_t i = 0; i < file_size; ++i)
+    {
+        data[i] = (uint8_t)(i * 7);
+    }
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+        output_file.write(reinterpret_cast<char*>(data.data()), file_size);
+    }
+
+    sak::pread_file_input_stream fs(file_name, 64);
+    EXPECT_TRUE(fs.is_open());
+    EXPECT_EQ(file_size, fs.size());
+
+    // Small reads are served from the buffer
+    uint8_t small[10];
+    fs.read(small, 10);
+    EXPECT_TRUE(std::equal(small, small + 10, data.begin()));
+    EXPECT_EQ(10U, fs.read_position());
+
+    // Seek backwards within the buffer
+    fs.seek(5);
+    fs.read(small, 10);
+    EXPECT_TRUE(std::equal(small, small + 10, data.begin() + 5));
+
+    // A read spanning the end of the buffer
+    fs.seek(60);
+    fs.read(small, 10);
+    EXPECT_TRUE(std::equal(small, small + 10, data.begin() + 60));
+
+    // A large read bypasses the buffer
+    std::vector<uint8_t> large(500);
+    fs.read(large.data(), 500);
+    EXPECT_TRUE(std::equal(large.begin(), large.end(), data.begin() + 70));
+    EXPECT_EQ(570U, fs.read_position());
+    EXPECT_EQ(430U, fs.bytes_available());
+
+    // Random access without the buffer
+    fs.advise(sak::pread_file_input_stream::access_pattern::random);
+    fs.seek(990);
+    fs.read(small, 10);
+    EXPECT_TRUE(std::equal(small, small + 10, data.begin() + 990));
+    EXPECT_EQ(0U, fs.bytes_available());
+
+    fs.advise(sak::pread_file_input_stream::access_pattern::sequential);
+    fs.advise(sak::pread_file_input_stream::access_pattern::willneed);
+    fs.seek(0);
+    std::vector<uint8_t> all(file_size);
+    fs.read(all.data(), file_size);
+    EXPECT_EQ(data, all);
+
+    fs.close();
+    EXPECT_FALSE(fs.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests reading into a sequence of storage buffers, both through the
+/// internal buffer and directly from the file
+TEST(TestPreadFileInputStream, ReadSequence)
+{
+    uint32_t file_size = 1000;
+    std::string file_name("test_sequence.bin");
+
+    std::vector<uint8_t> data(file_size);
+    for (uint32_t i = 0; i < file_size; ++i)
+    {
+        data[i] = (uint8_t)(i * 11);
+    }
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+        output_file.write(reinterpret_cast<char*>(data.data()), file_size);
+    }
+
+    sak::pread_file_input_stream fs(file_name, 128);
+
+    std::vector<uint8_t> header(4);
+    std::vector<uint8_t> payload(60);
+
+    std::vector<sak::mutable_storage> small;
+    small.push_back(sak::storage(header));
+    small.push_back(sak::storage(payload));
+
+    // A small read is copied from the internal buffer, twice
+    fs.read(small.data(), small.data() + small.size());
+    EXPECT_TRUE(std::equal(header.begin(), header.end(), data.begin()));
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(),
+                           data.begin() + 4));
+
+    fs.read(small.data(), small.data() + small.size());
+    EXPECT_TRUE(std::equal(header.begin(), header.end(), data.begin() + 64));
+    EXPECT_TRUE(std::equal(payload.begin(), payload.end(),
+                           data.begin() + 68));
+    EXPECT_EQ(128U, fs.read_position());
+
+    // A large read goes directly to the buffers
+    std::vector<uint8_t> symbols(600);
+    std::vector<sak::mutable_storage> large;
+    large.push_back(sak::storage(header));
+    large.push_back(sak::mutable_storage());
+    for (uint32_t i = 0; i < 6; ++i)
+    {
+        large.push_back(sak::storage(symbols.data() + i * 100, 100));
+    }
+
+    fs.read(large.data(), large.data() + large.size());
+    EXPECT_TRUE(std::equal(header.begin(), header.end(), data.begin() + 128));
+    EXPECT_TRUE(std::equal(symbols.begin(), symbols.end(),
+                           data.begin() + 132));
+    EXPECT_EQ(732U, fs.read_position());
+    EXPECT_EQ(268U, fs.bytes_available());
+
+    fs.close();
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that peek() returns data from the internal buffer
+TEST(TestPreadFileInputStream, PeekAndConsume)
+{
+    uint32_t file_size = 300;
+    std::string file_name("test_peek.bin");
+
+    std::vector<uint8_t> data(file_size);
+    for (uint32_t i = 0; i < file_size; ++i)
+    {
+        data[i] = (uint8_t)(i * 13);
+    }
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+        output_file.write(reinterpret_cast<char*>(data.data()), file_size);
+    }
+
+    sak::pread_file_input_stream fs(file_name, 64);
+
+    sak::const_storage view = fs.peek(40);
+    ASSERT_EQ(40U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 40, data.begin()));
+    EXPECT_EQ(0U, fs.read_position());
+
+    // Peeking past the end of the internal buffer refills it
+    fs.consume(40);
+    view = fs.peek(40);
+    ASSERT_EQ(40U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 40,
+                           data.begin() + 40));
+
+    // Peeking more than the internal buffer copies the data
+    view = fs.peek(200);
+    ASSERT_EQ(200U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 200,
+                           data.begin() + 40));
+    EXPECT_EQ(40U, fs.read_position());
+
+    fs.consume(250);
+    EXPECT_EQ(10U, fs.peek(40).m_size);
+
+    fs.close();
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that reads fail without moving the position when the file is
+/// truncated after it was opened
+TEST(TestPreadFileInputStream, TruncatedFile)
+{
+    std::string file_name("test_truncated.bin");
+
+    {
+        std::vector<uint8_t> data(1000, 0x42);
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+        output_file.write(reinterpret_cast<char*>(data.data()), 1000);
+    }
+
+    sak::pread_file_input_stream fs(file_name, 64);
+    ASSERT_EQ(0, ::truncate(file_name.c_str(), 100));
+
+    std::error_code ec;
+    std::vector<uint8_t> buffer(500);
+
+    // A large read bypassing the buffer
+    fs.read(buffer.data(), 500, ec);
+    EXPECT_EQ(sak::error::failed_read_file, ec);
+    EXPECT_EQ(0U, fs.read_position());
+
+    // A small read through the buffer
+    ec.clear();
+    fs.seek(200);
+    fs.read(buffer.data(), 10, ec);
+    EXPECT_EQ(sak::error::failed_read_file, ec);
+    EXPECT_EQ(200U, fs.read_position());
+
+    // A read into a sequence of buffers
+    ec.clear();
+    std::vector<sak::mutable_storage> sequence =
+        sak::split_storage(sak::storage(buffer), 100);
+    fs.seek(0);
+    fs.read(sequence.data(), sequence.data() + sequence.size(), ec);
+    EXPECT_EQ(sak::error::failed_read_file, ec);
+    EXPECT_EQ(0U, fs.read_position());
+
+    // Without an error callback the failure is thrown
+    EXPECT_THROW(fs.read(buffer.data(), 500), std::system_error);
+
+    std::string message;
+    fs.on_error([&message](const std::string& error)
+    {
+        message = error;
+    });
+
+    fs.read(buffer.data(), 500);
+    EXPECT_EQ("Failed to read file", message);
+    EXPECT_EQ(0U, fs.read_position());
+
+    // The data still in the file can be read
+    ec.clear();
+    fs.read(buffer.data(), 100, ec);
+    EXPECT_FALSE(ec);
+    EXPECT_EQ(100U, fs.read_position());
+
+    fs.close();
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+/// Tests that files which do not fit in 32 bits are rejected
+TEST(TestPreadFileInputStream, FileTooLarge)
+{
+    std::string file_name("test_too_large.bin");
+
+    {
+        std::ofstream output_file(
+            file_name.c_str(), std::ios::out | std::ios::binary);
+    }
+
+    // Create a sparse file of 4 GiB
+    ASSERT_EQ(0, ::truncate(file_name.c_str(), 0x100000000LL));
+
+    sak::pread_file_input_stream fs;
+
+    std::error_code ec;
+    fs.open(file_name, ec);
+    EXPECT_EQ(sak::error::file_too_large, ec);
+    EXPECT_FALSE(fs.is_open());
+
+    EXPECT_EQ(0, std::remove(file_name.c_str()));
+}
+
+#endif
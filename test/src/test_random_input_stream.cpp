@@ -56,3 +56,20 @@ TEST(TestRandomInputStream, CreateRandomInputStream)
     EXPECT_TRUE(std::equal(buffer_out.begin(), buffer_out.end(),
                            stream.data()));
 }
+
+/// Tests that peek() returns the data without copying it
+TEST(TestRandomInputStream, PeekAndConsume)
+{
+    sak::random_input_stream stream(100);
+
+    sak::const_storage view = stream.peek(30);
+    EXPECT_EQ(stream.data(), view.m_data);
+    EXPECT_EQ(30U, view.m_size);
+
+    stream.consume(90);
+    EXPECT_EQ(90U, stream.read_position());
+
+    view = stream.peek(30);
+    EXPECT_EQ(stream.data() + 90, view.m_data);
+    EXPECT_EQ(10U, view.m_size);
+}
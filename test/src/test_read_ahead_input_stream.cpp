@@ -0,0 +1,200 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/read_ahead_input_stream.hpp>
+#include <sak/random_input_stream.hpp>
+#include <sak/error.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+/// A random stream failing to read past a position, either by throwing
+/// or by reporting the error and not moving the read position
+struct failing_input_stream : public sak::random_input_stream
+{
+    failing_input_stream(uint32_t size, uint32_t limit, bool throws) :
+        sak::random_input_stream(size),
+        m_limit(limit),
+        m_throws(throws)
+    { }
+
+    void read(uint8_t* buffer, uint32_t bytes) override
+    {
+        if (m_current_pos + bytes <= m_limit)
+        {
+            sak::random_input_stream::read(buffer, bytes);
+        }
+        else if (m_throws)
+        {
+            throw std::runtime_error("read failed");
+        }
+    }
+
+    uint32_t m_limit;
+    bool m_throws;
+};
+}
+
+/// Tests reading a stream sequentially through the read-ahead buffers
+TEST(TestReadAheadInputStream, ReadSequential)
+{
+    auto random = std::make_shared<sak::random_input_stream>(10000);
+    sak::read_ahead_input_stream stream(random, 3, 1000);
+
+    EXPECT_EQ(10000U, stream.size());
+    EXPECT_EQ(10000U, stream.bytes_available());
+    EXPECT_EQ(0U, stream.read_position());
+    EXPECT_TRUE(stream.stopped());
+
+    std::vector<uint8_t> result(10000);
+    uint32_t position = 0;
+
+    // Use a read size which does not match the buffer size
+    while (stream.bytes_available() > 0)
+    {
+        uint32_t bytes = std::min(700U, stream.bytes_available());
+        stream.read(result.data() + position, bytes);
+        position += bytes;
+
+        EXPECT_EQ(position, stream.read_position());
+    }
+
+    EXPECT_TRUE(std::equal(result.begin(), result.end(), random->data()));
+}
+
+/// Tests that seeking discards the data read ahead
+TEST(TestReadAheadInputStream, Seek)
+{
+    auto random = std::make_shared<sak::random_input_stream>(10000);
+    random->seek(500);
+
+    sak::read_ahead_input_stream stream(random, 2, 256);
+    EXPECT_EQ(500U, stream.read_position());
+    EXPECT_EQ(9500U, stream.bytes_available());
+
+    std::vector<uint8_t> buffer(300);
+    stream.read(buffer.data(), 300);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(),
+                           random->data() + 500));
+
+    // Seek backwards
+    stream.seek(100);
+    EXPECT_EQ(100U, stream.read_position());
+    stream.read(buffer.data(), 300);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(),
+                           random->data() + 100));
+
+    // Seek forwards
+    stream.seek(9700);
+    EXPECT_EQ(300U, stream.bytes_available());
+    stream.read(buffer.data(), 300);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(),
+                           random->data() + 9700));
+    EXPECT_EQ(0U, stream.bytes_available());
+
+    // Seek to the end and back to the start
+    stream.seek(10000);
+    stream.seek(0);
+    stream.read(buffer.data(), 300);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), random->data()));
+}
+
+/// Tests peeking within a block, across blocks and beyond the buffers
+TEST(TestReadAheadInputStream, PeekAndConsume)
+{
+    auto random = std::make_shared<sak::random_input_stream>(10000);
+    sak::read_ahead_input_stream stream(random, 3, 100);
+
+    sak::const_storage view = stream.peek(50);
+    ASSERT_EQ(50U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 50, random->data()));
+    EXPECT_EQ(0U, stream.read_position());
+
+    stream.consume(70);
+    view = stream.peek(200);
+    ASSERT_EQ(200U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 200,
+                           random->data() + 70));
+
+    // More than the buffers can hold
+    view = stream.peek(1000);
+    ASSERT_EQ(1000U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 1000,
+                           random->data() + 70));
+    EXPECT_EQ(70U, stream.read_position());
+
+    // Served from the data taken out of the blocks by the last peek
+    stream.consume(30);
+    view = stream.peek(1200);
+    ASSERT_EQ(1200U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 1200,
+                           random->data() + 100));
+    stream.consume(1200);
+    view = stream.peek(10);
+    ASSERT_EQ(10U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 10,
+                           random->data() + 1300));
+
+    stream.consume(8670);
+    view = stream.peek(100);
+    ASSERT_EQ(30U, view.m_size);
+    EXPECT_TRUE(std::equal(view.m_data, view.m_data + 30,
+                           random->data() + 9970));
+
+    std::vector<uint8_t> buffer(30);
+    stream.read(buffer.data(), 30);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(),
+                           random->data() + 9970));
+}
+
+/// Tests that a failed read of the background thread is rethrown to the
+/// consumer once the data read before it has been delivered
+TEST(TestReadAheadInputStream, ReadFailure)
+{
+    auto failing = std::make_shared<failing_input_stream>(1000, 250, true);
+    sak::read_ahead_input_stream stream(failing, 2, 100);
+
+    std::vector<uint8_t> buffer(200);
+    stream.read(buffer.data(), 200);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), failing->data()));
+
+    EXPECT_THROW(stream.read(buffer.data(), 50), std::runtime_error);
+    EXPECT_THROW(stream.peek(10), std::runtime_error);
+    EXPECT_THROW(stream.consume(10), std::runtime_error);
+    EXPECT_EQ(200U, stream.read_position());
+}
+
+/// Tests that a wrapped stream not moving past a read is reported as a
+/// failed read
+TEST(TestReadAheadInputStream, ReadFailureWithoutException)
+{
+    auto failing = std::make_shared<failing_input_stream>(1000, 250, false);
+    sak::read_ahead_input_stream stream(failing, 2, 100);
+
+    // The peek takes the first two blocks out before reaching the failure
+    try
+    {
+        stream.peek(300);
+        ADD_FAILURE() << "Expected a failed read";
+    }
+    catch (const std::system_error& e)
+    {
+        EXPECT_EQ(sak::error::failed_read_file, e.code());
+    }
+
+    // The data taken by the peek is still delivered
+    std::vector<uint8_t> buffer(200);
+    stream.read(buffer.data(), 200);
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), failing->data()));
+    EXPECT_THROW(stream.read(buffer.data(), 1), std::system_error);
+}
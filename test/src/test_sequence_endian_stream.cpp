@@ -0,0 +1,94 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/sequence_endian_stream.hpp>
+#include <sak/endian_stream.hpp>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(TestSequenceEndianStream, write_read_split_storage)
+{
+    const uint32_t elements = 100;
+    std::vector<uint8_t> buffer(elements * 7);
+
+    // Split the buffer in chunks so values straddle the boundaries
+    auto sequence = sak::split_storage(sak::storage(buffer), 5);
+
+    auto stream = sak::make_sequence_endian_stream(
+        sequence.begin(), sequence.end());
+    EXPECT_EQ(buffer.size(), stream.size());
+    EXPECT_EQ(0U, stream.position());
+
+    for (uint32_t i = 0; i < elements; ++i)
+    {
+        stream.write<uint8_t>(i % 256);
+        stream.write<uint16_t>(i);
+        stream.write<uint32_t>(i * 1000);
+    }
+    EXPECT_EQ(buffer.size(), stream.position());
+    EXPECT_EQ(0U, stream.remaining_size());
+
+    // The data is laid out as if written to a contiguous buffer
+    sak::endian_stream contiguous(sak::storage(buffer));
+    for (uint32_t i = 0; i < elements; ++i)
+    {
+        uint8_t u8 = 0;
+        uint16_t u16 = 0;
+        uint32_t u32 = 0;
+        contiguous.read(u8);
+        contiguous.read(u16);
+        contiguous.read(u32);
+        EXPECT_EQ(i % 256, u8);
+        EXPECT_EQ(i, u16);
+        EXPECT_EQ(i * 1000, u32);
+    }
+
+    // Read back through a const storage sequence
+    std::vector<sak::const_storage> const_sequence(
+        sequence.begin(), sequence.end());
+    auto reader = sak::make_sequence_endian_stream(
+        const_sequence.begin(), const_sequence.end());
+
+    reader.seek(7 * 10);
+    uint8_t u8 = 0;
+    uint16_t u16 = 0;
+    uint32_t u32 = 0;
+    reader.read(u8);
+    reader.read(u16);
+    reader.read(u32);
+    EXPECT_EQ(10U, u8);
+    EXPECT_EQ(10U, u16);
+    EXPECT_EQ(10000U, u32);
+    EXPECT_EQ(77U, reader.position());
+}
+
+TEST(TestSequenceEndianStream, header_and_payload)
+{
+    std::vector<uint8_t> header(4);
+    std::string payload("some payload data");
+
+    std::vector<sak::mutable_storage> sequence;
+    sequence.push_back(sak::storage(header));
+    sequence.push_back(sak::mutable_storage());
+    sequence.push_back(sak::storage(payload));
+
+    sak::sequence_endian_stream<std::vector<sak::mutable_storage>::iterator>
+        stream(sequence.begin(), sequence.end());
+
+    std::string text("a text in two buffers");
+    ASSERT_EQ(stream.size(), text.size());
+    stream.write(sak::storage(text));
+
+    std::string out(text.size(), '\0');
+    stream.seek(0);
+    stream.read(sak::storage(out));
+    EXPECT_EQ(text, out);
+
+    EXPECT_EQ(std::string("a te"), std::string(header.begin(), header.end()));
+    EXPECT_EQ(text.substr(4), payload);
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2016 Steinwurf ApS
+// All Rights Reserved
+//
+// Distributed under the "BSD License". See the accompanying LICENSE.rst file.
+
+#include <sak/symbol_chunker.hpp>
+#include <sak/random_input_stream.hpp>
+#include <sak/buffer_input_stream.hpp>
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// Random stream whose reads fail while m_fail is set. As required of
+// input streams, the failure is reported through the error callback and
+// the read position is not moved.
+struct unreadable_input_stream : public sak::random_input_stream
+{
+    unreadable_input_stream(uint32_t size) :
+        sak::random_input_stream(size),
+        m_fail(false)
+    { }
+
+    void read(uint8_t* buffer, uint32_t bytes) override
+    {
+        if (!m_fail)
+        {
+            sak::random_input_stream::read(buffer, bytes);
+        }
+        else if (m_error_callback)
+        {
+            m_error_callback("read failed");
+        }
+    }
+
+    bool m_fail;
+};
+}
+
+/// Tests cutting a stream into generations with a padded last symbol
+TEST(TestSymbolChunker, Generations)
+{
+    auto stream = std::make_shared<sak::random_input_stream>(1000);
+    sak::symbol_chunker chunker(stream, 64, 4);
+
+    EXPECT_EQ(1000U, chunker.size());
+    EXPECT_EQ(64U, chunker.symbol_size());
+    EXPECT_EQ(4U, chunker.generation_size());
+    EXPECT_EQ(16U, chunker.symbols());
+    EXPECT_EQ(4U, chunker.generations());
+    EXPECT_EQ(4U, chunker.symbols(3));
+
+    std::vector<uint8_t> result;
+
+    while (!chunker.finished())
+    {
+        uint32_t generation = chunker.generation();
+        sak::mutable_storage symbols = chunker.next();
+
+        EXPECT_EQ(generation + 1, chunker.generation());
+        EXPECT_EQ(256U, symbols.m_size);
+        EXPECT_EQ(4U, sak::split_storage(symbols, 64).size());
+
+        result.insert(result.end(), symbols.m_data,
+                      symbols.m_data + symbols.m_size);
+    }
+
+    ASSERT_EQ(1024U, result.size());
+    EXPECT_TRUE(std::equal(result.begin(), result.begin() + 1000,
+                           stream->data()));
+    EXPECT_EQ(std::vector<uint8_t>(24, 0),
+              std::vector<uint8_t>(result.begin() + 1000, result.end()));
+}
+
+/// Tests that the last generation can contain fewer symbols and that
+/// the generations can be read again
+TEST(TestSymbolChunker, PartialGeneration)
+{
+    auto stream = std::make_shared<sak::random_input_stream>(1000);
+
+    // Start from an offset in the stream
+    stream->seek(100);
+    sak::symbol_chunker chunker(stream, 100, 4, 2);
+
+    EXPECT_EQ(900U, chunker.size());
+    EXPECT_EQ(9U, chunker.symbols());
+    EXPECT_EQ(3U, chunker.generations());
+    EXPECT_EQ(4U, chunker.symbols(1));
+    EXPECT_EQ(1U, chunker.symbols(2));
+
+    sak::mutable_storage first = chunker.next();
+    sak::mutable_storage second = chunker.next();
+    sak::mutable_storage third = chunker.next();
+    EXPECT_TRUE(chunker.finished());
+
+    // Two buffers are recycled
+    EXPECT_NE(first.m_data, second.m_data);
+    EXPECT_EQ(first.m_data, third.m_data);
+
+    EXPECT_EQ(100U, third.m_size);
+    EXPECT_TRUE(std::equal(third.m_data, third.m_data + third.m_size,
+                           stream->data() + 900));
+
+    // Read the stream again
+    chunker.reset();
+    EXPECT_EQ(0U, chunker.generation());
+    EXPECT_EQ(100U, stream->read_position());
+
+    sak::mutable_storage symbols = chunker.next();
+    EXPECT_EQ(400U, symbols.m_size);
+    EXPECT_TRUE(std::equal(symbols.m_data, symbols.m_data + 400,
+                           stream->data() + 100));
+}
+
+/// Tests a stream which ends in the middle of a symbol of the last
+/// generation when the buffers have been used before
+TEST(TestSymbolChunker, PaddingRecycledBuffer)
+{
+    auto stream = std::make_shared<sak::random_input_stream>(250);
+    sak::symbol_chunker chunker(stream, 100, 2);
+
+    EXPECT_EQ(2U, chunker.generations());
+
+    sak::mutable_storage first = chunker.next();
+    EXPECT_EQ(200U, first.m_size);
+
+    sak::mutable_storage second = chunker.next();
+    EXPECT_EQ(first.m_data, second.m_data);
+    EXPECT_EQ(100U, second.m_size);
+
+    EXPECT_TRUE(std::equal(second.m_data, second.m_data + 50,
+                           stream->data() + 200));
+    EXPECT_TRUE(std::all_of(second.m_data + 50, second.m_data + 100,
+                            [](uint8_t value) { return value == 0; }));
+}
+
+/// Tests a stream with no data left
+TEST(TestSymbolChunker, Empty)
+{
+    std::vector<uint8_t> data(100);
+    auto stream = std::make_shared<sak::buffer_input_stream>(
+        sak::storage(data));
+    stream->seek(100);
+
+    sak::symbol_chunker chunker(stream, 10, 4);
+    EXPECT_EQ(0U, chunker.symbols());
+    EXPECT_EQ(0U, chunker.generations());
+    EXPECT_TRUE(chunker.finished());
+}
+
+/// Tests that a failed read is reported and the generation can be read
+/// again
+TEST(TestSymbolChunker, ReadFails)
+{
+    auto stream = std::make_shared<unreadable_input_stream>(1000);
+    sak::symbol_chunker chunker(stream, 100, 5);
+
+    uint32_t errors = 0;
+    stream->on_error([&](const std::string&) { ++errors; });
+
+    chunker.next();
+    stream->m_fail = true;
+
+    std::error_code ec;
+    sak::mutable_storage symbols = chunker.next(ec);
+    EXPECT_EQ(sak::error::failed_read_file, ec);
+    EXPECT_EQ(1U, errors);
+    EXPECT_EQ(0U, symbols.m_size);
+    EXPECT_EQ(1U, chunker.generation());
+    EXPECT_EQ(500U, stream->read_position());
+
+    stream->m_fail = false;
+
+    ec.clear();
+    symbols = chunker.next(ec);
+    EXPECT_FALSE(ec);
+    ASSERT_EQ(500U, symbols.m_size);
+    EXPECT_TRUE(std::equal(symbols.m_data, symbols.m_data + 500,
+                           stream->data() + 500));
+    EXPECT_TRUE(chunker.finished());
+}
+
+/// Tests that next() throws if the read fails
+TEST(TestSymbolChunker, ReadFailsThrows)
+{
+    auto stream = std::make_shared<unreadable_input_stream>(1000);
+    stream->m_fail = true;
+
+    sak::symbol_chunker chunker(stream, 100, 5);
+
+    EXPECT_THROW(chunker.next(), std::system_error);
+    EXPECT_EQ(0U, chunker.generation());
+}